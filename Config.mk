@@ -2,8 +2,8 @@ MAKENAME = INE5424
 
 INTERFACE_NAME:=$(shell ip addr | awk '/state UP/ {print $$2}' | head -n 1 | sed 's/.$$//')
 
-TEST_MODULES = e1 e2 e3 e4 e5 e6 e7
-TESTS = e1/e1_communicator_test e1/e1_load_test e1/e1_latency_test e2/e2_one_to_one_test e2/e2_latency_test e2/e2_throughput_test e2/e2_many_to_many_test e2/e2_many_to_one_test e2/e2_broadcast_test e2/e2_broadcast_neighborhood_test e3/e3_one_pub_sub_test e3/e3_one_pub_many_subs_test e3/e3_already_running_test e3/e3_response_time_test e3/e3_many_pubs_subs_test e3/e3_unsubscribe_test e4/e4_components_same_car e4/e4_components_many_cars e4/e4_send_time_test e4/e4_one_to_one_time_test e5/e5_quadrant_test e5/e5_validate_mac_test e5/e5_drop_test e5/e5_out_of_range_test e5/e5_diff_quadrant_test e6/e6_shared_mem_test e6/e6_socket_test e6/e6_intra_inter_test e7/e7_delay_test e7/e7_simulation_test e7/e7_test_one_receiver
+TEST_MODULES = e1 e2 e3 e4 e5 e6 e7 perf
+TESTS = e1/e1_communicator_test e1/e1_load_test e1/e1_latency_test e2/e2_one_to_one_test e2/e2_latency_test e2/e2_throughput_test e2/e2_many_to_many_test e2/e2_many_to_one_test e2/e2_broadcast_test e2/e2_broadcast_neighborhood_test e2/e2_multi_instance_test e3/e3_one_pub_sub_test e3/e3_one_pub_many_subs_test e3/e3_already_running_test e3/e3_response_time_test e3/e3_many_pubs_subs_test e3/e3_unsubscribe_test e4/e4_components_same_car e4/e4_components_many_cars e4/e4_send_time_test e4/e4_one_to_one_time_test e4/e4_kernel_timestamp_test e5/e5_quadrant_test e5/e5_validate_mac_test e5/e5_drop_test e5/e5_out_of_range_test e5/e5_diff_quadrant_test e5/e5_udp_multicast_test e5/e5_statistics_test e5/e5_backpressure_test e6/e6_shared_mem_test e6/e6_socket_test e6/e6_intra_inter_test e6/e6_shm_medium_test e7/e7_delay_test e7/e7_simulation_test e7/e7_test_one_receiver perf/perf_xdp_engine_test perf/perf_io_uring_engine_test perf/perf_buffer_pool_test perf/perf_async_tx_test perf/perf_tx_sockets_test perf/perf_shared_engine_test perf/perf_local_dispatch_test perf/perf_observer_registry_test perf/perf_observer_queue_test perf/perf_fanout_test perf/perf_rx_modes_test
 MODULES = ethernet shared_mem utils mac
 
 SRC_DIR = src
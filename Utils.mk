@@ -14,6 +14,9 @@ define run_tests =
 		echo $(MAKENAME) "Testing: running" `basename $$test`; \
 		echo "--------------------------------------";         \
 		./$(BIN_DIR)/$$test;                                   \
+		if [ $$? -eq 77 ]; then                                \
+			echo $(MAKENAME) "Testing: skipped" `basename $$test`; \
+		fi;                                                    \
 	done
 endef
 
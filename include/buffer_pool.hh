@@ -0,0 +1,278 @@
+#ifndef BUFFER_POOL_HH
+#define BUFFER_POOL_HH
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "buffer.hh"
+
+// Pool de Buffers com alocação e liberação O(1) e sem travas.
+//
+// Os buffers livres formam uma pilha de índices (Treiber) cujo topo guarda
+// uma etiqueta incrementada a cada troca, evitando o problema ABA. Cada
+// thread mantém um magazine por pool: alloc e free usam apenas o magazine e
+// só tocam a pilha compartilhada para reabastecê-lo (meio magazine por vez)
+// ou esvaziá-lo (meio magazine com uma única troca atômica).
+//
+// Os buffers de um pool têm todos a mesma capacidade (classe de tamanho).
+// Seus campos de controle e, em seguida, suas áreas de dados, alinhadas à
+// linha de cache, ficam em uma única área mmap, em páginas enormes sempre
+// que possível. A área é pré-carregada e travada
+// na memória (mlock), de modo que a recepção não sofre faltas de página ao
+// tocar um buffer.
+//
+// Os magazines guardam um shared_ptr para o pool, então os pools são
+// criados por create() e permanecem vivos até que a última thread que os
+// usou devolva seus buffers.
+class BufferPool : public std::enable_shared_from_this<BufferPool> {
+public:
+  // Buffers guardados por thread em cada magazine
+  static constexpr unsigned int MAGAZINE_SIZE = 16;
+  // Pools com magazine simultâneo em uma mesma thread
+  static constexpr unsigned int MAGAZINES_PER_THREAD = 8;
+  // Tamanho das páginas enormes usadas com MAP_HUGETLB
+  static constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+  // Cria um pool com count buffers do tipo type, com capacity bytes cada.
+  static std::shared_ptr<BufferPool>
+  create(unsigned int count, Buffer::BufferType type,
+         unsigned int capacity = Buffer::BUFFER_SIZE) {
+    return std::shared_ptr<BufferPool>(new BufferPool(count, type, capacity));
+  }
+
+  BufferPool(const BufferPool &) = delete;
+  BufferPool &operator=(const BufferPool &) = delete;
+
+  ~BufferPool() {
+    for (unsigned int i = 0; i < _count; i++) {
+      _buffers[i].~Buffer();
+    }
+    munlock(_buffers, _map_size);
+    munmap(_buffers, _map_size);
+  }
+
+  // Retira um buffer livre do pool e o marca como em uso.
+  // Returns:
+  //   Ponteiro para o buffer, ou nullptr se o pool estiver esgotado.
+  Buffer *alloc() {
+    Magazine &mag = magazine();
+    if (mag.count == 0) {
+      while (mag.count < MAGAZINE_SIZE / 2) {
+        uint32_t index = pop();
+        if (index == NIL) {
+          break;
+        }
+        mag.items[mag.count++] = index;
+      }
+      if (mag.count == 0) {
+        return nullptr;
+      }
+    }
+    Buffer *buf = &_buffers[mag.items[--mag.count]];
+    buf->mark_in_use();
+    return buf;
+  }
+
+  // Devolve ao pool um buffer obtido por alloc().
+  // Args:
+  //   buf: Buffer do pool (ver owns()).
+  void free(Buffer *buf) {
+    buf->mark_free();
+    Magazine &mag = magazine();
+    if (mag.count == MAGAZINE_SIZE) {
+      flush(mag, MAGAZINE_SIZE / 2);
+    }
+    mag.items[mag.count++] = static_cast<uint32_t>(buf - _buffers);
+  }
+
+  // Verifica se o buffer pertence a este pool.
+  bool owns(const Buffer *buf) const {
+    return buf >= _buffers && buf < _buffers + _count;
+  }
+
+  unsigned int capacity() const {
+    return _count;
+  }
+
+  // Capacidade de cada buffer do pool (em bytes).
+  unsigned int buffer_size() const {
+    return _buffer_size;
+  }
+
+  // Verifica se a área dos buffers está em páginas enormes (MAP_HUGETLB).
+  bool huge_pages() const {
+    return _huge_pages;
+  }
+
+  // Verifica se a área dos buffers está travada na memória (mlock). Falha
+  // com RLIMIT_MEMLOCK menor que a área.
+  bool locked() const {
+    return _locked;
+  }
+
+private:
+  static constexpr uint32_t NIL = UINT32_MAX;
+
+  BufferPool(unsigned int count, Buffer::BufferType type,
+             unsigned int capacity)
+      : _count(count), _buffer_size(capacity),
+        _next(new std::atomic<uint32_t>[count]) {
+    // A área vem zerada do mmap, como o buffer espera
+    size_t stride = round_up(capacity, Buffer::CACHE_LINE);
+    map(count * (sizeof(Buffer) + stride));
+    std::byte *data = reinterpret_cast<std::byte *>(_buffers + count);
+    for (unsigned int i = 0; i < count; i++) {
+      new (&_buffers[i]) Buffer(type, data + i * stride, capacity);
+      _next[i].store(i + 1 < count ? i + 1 : NIL, std::memory_order_relaxed);
+    }
+    _head.store(pack(0, count > 0 ? 0 : NIL), std::memory_order_release);
+  }
+
+  // Reserva a área dos buffers. Tenta páginas enormes reservadas
+  // (MAP_HUGETLB); se o sistema não tiver nenhuma, usa páginas comuns e
+  // pede páginas enormes transparentes (MADV_HUGEPAGE). Nos dois casos a
+  // área é pré-carregada (MAP_POPULATE) e travada; sem permissão para
+  // travá-la (RLIMIT_MEMLOCK), o pool funciona normalmente e locked()
+  // informa a falha.
+  // Args:
+  //   bytes: Tamanho mínimo da área.
+  void map(size_t bytes) {
+    bytes = bytes > 0 ? bytes : 1;
+    _map_size = round_up(bytes, HUGE_PAGE_SIZE);
+    void *area = mmap(nullptr, _map_size, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | MAP_POPULATE,
+                      -1, 0);
+    _huge_pages = area != MAP_FAILED;
+    if (!_huge_pages) {
+      _map_size = round_up(bytes, static_cast<size_t>(sysconf(_SC_PAGESIZE)));
+      area = mmap(nullptr, _map_size, PROT_READ | PROT_WRITE,
+                  MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
+      if (area == MAP_FAILED) {
+        perror("mmap (BufferPool)");
+        exit(EXIT_FAILURE);
+      }
+      // As páginas já carregadas podem ser agrupadas depois (khugepaged)
+      madvise(area, _map_size, MADV_HUGEPAGE);
+    }
+    _locked = mlock(area, _map_size) == 0;
+    _buffers = static_cast<Buffer *>(area);
+  }
+
+  static size_t round_up(size_t bytes, size_t unit) {
+    return (bytes + unit - 1) / unit * unit;
+  }
+
+  // Buffers de um pool guardados por uma thread.
+  struct Magazine {
+    std::shared_ptr<BufferPool> pool;
+    unsigned int count = 0;
+    std::array<uint32_t, MAGAZINE_SIZE> items;
+  };
+
+  // Magazines de uma thread. Ao terminar, a thread devolve os buffers
+  // guardados.
+  struct ThreadCache {
+    std::array<Magazine, MAGAZINES_PER_THREAD> magazines;
+    unsigned int victim = 0;
+
+    ~ThreadCache() {
+      for (Magazine &mag : magazines) {
+        if (mag.pool) {
+          mag.pool->flush(mag, mag.count);
+        }
+      }
+    }
+  };
+
+  // Retorna o magazine da thread atual para este pool. Sem posição livre,
+  // esvazia o magazine de outro pool (rodízio).
+  Magazine &magazine() {
+    static thread_local ThreadCache cache;
+    Magazine *empty = nullptr;
+    for (Magazine &mag : cache.magazines) {
+      if (mag.pool.get() == this) {
+        return mag;
+      }
+      if (!mag.pool && empty == nullptr) {
+        empty = &mag;
+      }
+    }
+    if (empty == nullptr) {
+      empty = &cache.magazines[cache.victim];
+      cache.victim = (cache.victim + 1) % MAGAZINES_PER_THREAD;
+      empty->pool->flush(*empty, empty->count);
+      empty->pool.reset();
+    }
+    empty->pool = shared_from_this();
+    empty->count = 0;
+    return *empty;
+  }
+
+  // Devolve à pilha os n últimos buffers do magazine, encadeados e
+  // publicados com uma única troca atômica.
+  void flush(Magazine &mag, unsigned int n) {
+    if (n == 0) {
+      return;
+    }
+    uint32_t first = mag.items[mag.count - n];
+    uint32_t last = mag.items[mag.count - 1];
+    for (unsigned int i = mag.count - n; i + 1 < mag.count; i++) {
+      _next[mag.items[i]].store(mag.items[i + 1], std::memory_order_relaxed);
+    }
+    mag.count -= n;
+
+    uint64_t head = _head.load(std::memory_order_relaxed);
+    do {
+      _next[last].store(index(head), std::memory_order_relaxed);
+    } while (!_head.compare_exchange_weak(head, pack(tag(head) + 1, first),
+                                          std::memory_order_release,
+                                          std::memory_order_relaxed));
+  }
+
+  // Retira um índice da pilha.
+  // Returns:
+  //   Índice do buffer ou NIL se a pilha estiver vazia.
+  uint32_t pop() {
+    uint64_t head = _head.load(std::memory_order_acquire);
+    while (index(head) != NIL) {
+      uint32_t next = _next[index(head)].load(std::memory_order_relaxed);
+      if (_head.compare_exchange_weak(head, pack(tag(head) + 1, next),
+                                      std::memory_order_acquire,
+                                      std::memory_order_acquire)) {
+        return index(head);
+      }
+    }
+    return NIL;
+  }
+
+  // Topo da pilha: etiqueta nos 32 bits altos e índice nos baixos
+  static uint64_t pack(uint32_t tag, uint32_t index) {
+    return (static_cast<uint64_t>(tag) << 32) | index;
+  }
+  static uint32_t tag(uint64_t head) {
+    return static_cast<uint32_t>(head >> 32);
+  }
+  static uint32_t index(uint64_t head) {
+    return static_cast<uint32_t>(head);
+  }
+
+  const unsigned int _count;
+  const unsigned int _buffer_size;
+  // Área mmap com os buffers, construídos no lugar, seguidos dos dados
+  Buffer *_buffers = nullptr;
+  size_t _map_size = 0;
+  bool _huge_pages = false;
+  bool _locked = false;
+  // Próximo índice de cada buffer na pilha de livres
+  std::unique_ptr<std::atomic<uint32_t>[]> _next;
+  std::atomic<uint64_t> _head;
+};
+
+#endif
@@ -6,7 +6,9 @@
 #include "concurrent_observer.hh"
 #include "cond.hh"
 #include "control.hh"
+#include <cstddef>
 #include <iostream>
+#include <span>
 
 template <typename Channel, typename Message>
 class Communicator
@@ -30,10 +32,17 @@ public:
   typedef Channel CommChannel;
 
   static const unsigned int MTU = Channel::MTU;
+  // Máximo de mensagens por chamada de receive_batch
+  static constexpr size_t BATCH_SIZE = 64;
 
 public:
-  Communicator(Channel *channel, Port port)
-      : _channel(channel),
+  // Args:
+  //   queue_size, overflow: Capacidade da fila de mensagens recebidas e
+  //   política de descarte quando ela enche (ver Concurrent_Observer).
+  Communicator(Channel *channel, Port port,
+               size_t queue_size = Observer::QUEUE_SIZE,
+               typename Observer::Overflow overflow = Observer::DropNewest)
+      : Observer(queue_size, overflow), _channel(channel),
         _address(Address(channel->getNICPAddr(), channel->getSysID(), port)) {
     _channel->attach(this, _address.getPort());
   }
@@ -68,6 +77,34 @@ public:
     return this->unmarshal(message, buf);
   }
 
+  // Recebe de uma vez todas as mensagens já enfileiradas, até o tamanho de
+  // messages, bloqueando apenas até a primeira.
+  // Returns:
+  //   Quantidade de mensagens preenchidas (as primeiras de messages).
+  size_t receive_batch(std::span<Message *> messages) {
+    return unmarshal_batch(*this, messages);
+  }
+
+  // Retira os buffers de um observador em uma única espera e preenche as
+  // mensagens.
+  // Args:
+  //   observer: Fila de onde os buffers são retirados (o próprio
+  //   Communicator ou um SmartData).
+  template <typename QueueObserver>
+  size_t unmarshal_batch(QueueObserver &observer,
+                         std::span<Message *> messages) {
+    Buffer *bufs[BATCH_SIZE];
+    size_t n = messages.size() < BATCH_SIZE ? messages.size() : BATCH_SIZE;
+    n = observer.updated_batch(std::span<Buffer *>(bufs, n));
+    size_t filled = 0;
+    for (size_t i = 0; i < n; i++) {
+      if (unmarshal(messages[filled], bufs[i])) {
+        filled++;
+      }
+    }
+    return filled;
+  }
+
   bool unmarshal(Message *message, Buffer *buf) {
     int size = _channel->receive(
         buf, message->sourceAddr(), message->destAddr(), message->getControl(),
@@ -98,6 +135,12 @@ public:
   }
 #endif
 
+protected:
+  // Buffer descartado com a fila cheia: volta ao pool
+  void discard(Buffer *buf) override {
+    _channel->free(buf);
+  }
+
 private:
   void update(typename Channel::Observer::Observing_Condition c, Buffer *buf) {
     Control::Type type = _channel->getPType(buf);
@@ -1,26 +1,56 @@
 #ifndef BUFFER_HH
 #define BUFFER_HH
 
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
-class Buffer {
+#include <cstring>
+
+// Buffer de um quadro. Os campos de controle ocupam uma linha de cache e os
+// dados ficam em uma área separada, cuja capacidade depende da classe de
+// tamanho do buffer (ver BufferPool).
+class alignas(64) Buffer {
 public:
   static constexpr size_t BUFFER_SIZE = 1514;
+  // Capacidade da classe de buffers pequenos (ex.: mensagens CAM)
+  static constexpr size_t SMALL_BUFFER_SIZE = 256;
+  static constexpr size_t CACHE_LINE = 64;
 
   enum BufferType { EthernetFrame, SharedMemFrame };
 
-  constexpr Buffer(BufferType buf_type = EthernetFrame)
-      : _type(buf_type), _size(0), _in_use(false), _receive_time(0)
+  // Buffer avulso, com área própria de BUFFER_SIZE bytes.
+  Buffer(BufferType buf_type = EthernetFrame)
+      : Buffer(buf_type, nullptr, BUFFER_SIZE) {
+  }
+
+  // Args:
+  //   data: Área de dados do buffer, que pertence ao chamador (ex.: pool).
+  //   Se nula, o buffer aloca a sua.
+  //   capacity: Tamanho da área de dados (em bytes).
+  Buffer(BufferType buf_type, std::byte *data, unsigned int capacity)
+      : _type(buf_type), _size(0), _capacity(capacity), _refs(0),
+        _in_use(false), _ext_ctx(-1), _ext(nullptr),
+        _data(data ? data : new std::byte[capacity]()),
+        _owned(data ? nullptr : _data), _receive_time(0), _kernel_time(0)
 #ifdef DEBUG_DELAY
       ,_temp_top_delay(0), _temp_bottom_delay(0)
 #endif
       {
   }
 
+  ~Buffer() {
+    delete[] _owned;
+  }
+
+  Buffer(const Buffer &) = delete;
+  Buffer &operator=(const Buffer &) = delete;
+
   // Retorna um ponteiro para o objeto Data contido no buffer.
+  // Se o buffer estiver associado a um quadro externo (attach), retorna o
+  // quadro externo.
   template <typename T>
   T *data() {
-    return reinterpret_cast<T *>(&_data);
+    return reinterpret_cast<T *>(_ext ? _ext : _data);
   }
 
   // Retorna o tamanho atual dos dados válidos no buffer (em bytes).
@@ -37,8 +67,8 @@ public:
   // Args:
   //   newSize: O novo tamanho dos dados.
   void setSize(int newSize) {
-    // Mínimo entre newSize e _max_size
-    _size = (newSize <= static_cast<int>(BUFFER_SIZE)) ? newSize : static_cast<int>(BUFFER_SIZE);
+    // Mínimo entre newSize e a capacidade
+    _size = (newSize <= maxSize()) ? newSize : maxSize();
   }
 
   constexpr int64_t get_receive_time() const {
@@ -49,9 +79,20 @@ public:
     _receive_time = rec_time;
   }
 
-  // Retorna a capacidade máxima do buffer (em bytes).
-  constexpr int maxSize() {
-    return BUFFER_SIZE;
+  // Instante (us, relógio do sistema) em que o kernel registrou a recepção
+  // do quadro (SO_TIMESTAMPING), ou 0 se a Engine não o forneceu.
+  constexpr int64_t get_kernel_time() const {
+    return _kernel_time;
+  }
+
+  void set_kernel_time(int64_t kernel_time) {
+    _kernel_time = kernel_time;
+  }
+
+  // Retorna a capacidade máxima do buffer (em bytes). Quadros externos
+  // (attach) sempre comportam BUFFER_SIZE bytes.
+  constexpr int maxSize() const {
+    return _ext ? static_cast<int>(BUFFER_SIZE) : _capacity;
   }
 
   // --- Métodos para Gerenciamento de Pool (usados pela NIC) ---
@@ -61,9 +102,29 @@ public:
     return _in_use;
   }
 
-  // Marca o buffer como em uso. Chamado pela NIC::alloc.
+  // Marca o buffer como em uso, com uma referência. Chamado pela NIC::alloc.
   void mark_in_use() {
     _in_use = true;
+    _refs.store(1, std::memory_order_relaxed);
+  }
+
+  // Adiciona uma referência: o buffer é entregue a mais um observador e
+  // só volta ao pool quando todos o liberarem.
+  void add_ref() {
+    _refs.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  // Remove uma referência. Chamado pela NIC::free.
+  // Returns:
+  //   true se era a última referência (o buffer pode voltar ao pool).
+  bool unref() {
+    return _refs.fetch_sub(1, std::memory_order_acq_rel) == 1;
+  }
+
+  // Zera apenas os bytes usados (size()) do quadro, mantendo zerada toda a
+  // área, já que quem preenche um buffer escreve até size().
+  void clear() {
+    std::memset(data<std::byte>(), 0, _size);
   }
 
   // Marca o buffer como livre. Chamado pela NIC::free.
@@ -71,14 +132,47 @@ public:
   void mark_free() {
     _in_use = false;
     _size = 0; // Importante resetar o tamanho ao liberar
+    _kernel_time = 0;
+  }
+
+  // --- Métodos para quadros externos (usados pela Engine) ---
+
+  // Associa o buffer a um quadro que pertence à Engine (ex.: anel mmap),
+  // evitando a cópia para _data.
+  // Args:
+  //   ext: início do quadro na memória da Engine.
+  //   ctx: identificador usado pela Engine para devolver o quadro.
+  void attach(std::byte *ext, int ctx) {
+    _ext = ext;
+    _ext_ctx = ctx;
+  }
+
+  // Desfaz a associação, voltando a usar a área interna do buffer.
+  void detach() {
+    _ext = nullptr;
+    _ext_ctx = -1;
+  }
+
+  constexpr bool is_attached() const {
+    return _ext != nullptr;
+  }
+
+  constexpr int ext_ctx() const {
+    return _ext_ctx;
   }
 
 private:
   BufferType _type;
   int _size;     // Tamanho atual dos dados válidos
+  int _capacity; // Tamanho da área _data
+  std::atomic<int> _refs; // Referências (observadores) ao buffer em uso
   bool _in_use;  // Flag para gerenciamento em um pool de buffers
-  std::byte _data[BUFFER_SIZE] = {};
+  int _ext_ctx;    // Contexto do quadro externo (ex.: bloco do anel)
+  std::byte *_ext; // Quadro externo associado (nullptr se usa _data)
+  std::byte *_data;
+  std::byte *_owned; // _data, se alocada pelo próprio buffer
   int64_t _receive_time;
+  int64_t _kernel_time; // Timestamp de recepção do kernel
 #ifdef DEBUG_DELAY
 public:
   int64_t _temp_top_delay;
@@ -58,15 +58,6 @@ public:
   private:
     unsigned char _data[MTU];
   } __attribute__((packed));
-
-  // Estrutura para estatísticas de transmissão/recepção
-  struct Statistics {
-    unsigned long long tx_packets;
-    unsigned long long tx_bytes;
-    unsigned long long rx_packets;
-    unsigned long long rx_bytes;
-    Statistics();
-  };
 };
 
 #endif
@@ -2,46 +2,138 @@
 #define ENGINE_HH
 
 #include <cerrno>
-#include <condition_variable>
-#include <csignal>
 #include <cstdio>
 #include <cstring>
 
 #include <arpa/inet.h>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <initializer_list>
 #include <iostream>
 #include <linux/filter.h>
+#include <linux/errqueue.h>
 #include <linux/if_packet.h>
+#include <linux/net_tstamp.h>
+#include <linux/sockios.h>
 #include <mutex>
 #include <net/if.h>
 #include <netinet/if_ether.h>
 #include <netinet/in.h>
+#include <poll.h>
 #include <semaphore.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
 #include <sys/ioctl.h>
 #include <sys/socket.h>
 #include <thread>
+#include <unistd.h>
+#include <utility>
+#include <vector>
 
 #include <fcntl.h>
 
 #include "buffer.hh"
+#include "engine_helpers.hh"
 #include "ethernet.hh"
+#include "packet_ring.hh"
 
 #ifdef DEBUG_DELAY
 #include "clocks.hh"
 #include "debug_timestamp.hh"
 #endif
 
-template <typename DataWrapper>
+// Política da thread de recepção da Engine.
+enum class RxPolicy {
+  // Dorme no epoll até a chegada de quadros
+  Blocking,
+  // Após cada rajada, continua consultando o socket sem bloquear por até
+  // Config::RX_SPIN_US antes de voltar a dormir
+  Adaptive,
+  // Nunca volta a dormir depois do primeiro quadro: consulta o socket
+  // continuamente, com SO_BUSY_POLL no socket
+  BusyPoll,
+};
+
+// Configuração da Engine em tempo de compilação. Para trocar o modo de
+// operação, herde desta estrutura e sobrescreva os campos desejados, ex.:
+//   struct RxRingConfig : DefaultEngineConfig {
+//     static constexpr bool RX_RING = true;
+//   };
+//   using SocketNIC = NIC<Engine<Ethernet, RxRingConfig>>;
+struct DefaultEngineConfig {
+  // Recepção pelo anel PACKET_RX_RING (TPACKET_V3) em vez de recvfrom
+  static constexpr bool RX_RING = false;
+  // Geometria do anel de recepção
+  static constexpr unsigned int RX_BLOCK_SIZE = 1 << 18;
+  static constexpr unsigned int RX_BLOCK_COUNT = 32;
+  static constexpr unsigned int RX_FRAME_SIZE = 2048;
+  // Tempo máximo (ms) que o kernel segura um bloco parcialmente preenchido
+  static constexpr unsigned int RX_BLOCK_TIMEOUT = 1;
+
+  // Transmissão pelo anel PACKET_TX_RING: NIC::alloc(1) entrega slots do
+  // próprio anel e um único kick envia a rajada pendente
+  static constexpr bool TX_RING = false;
+  // Geometria do anel de transmissão
+  static constexpr unsigned int TX_FRAME_SIZE = 2048;
+  static constexpr unsigned int TX_FRAME_COUNT = 256;
+
+  // Quantidade máxima de quadros por chamada de receive_burst feita pela
+  // NIC (recvmmsg). Com 1 a NIC volta a receber um quadro por vez.
+  static constexpr unsigned int RX_BURST = 32;
+
+  // Política da thread de recepção
+  static constexpr RxPolicy RX_POLICY = RxPolicy::Blocking;
+  // Tempo (us) sem quadros até a política Adaptive voltar a dormir
+  static constexpr unsigned int RX_SPIN_US = 50;
+  // Valor de SO_BUSY_POLL (us) na política BusyPoll
+  static constexpr int RX_BUSY_POLL_US = 50;
+
+  // Quantidade de sockets de recepção, cada um com sua própria thread. Com
+  // mais de um, os sockets formam um grupo PACKET_FANOUT e os quadros são
+  // distribuídos por origem, preservando a ordem de cada origem.
+  static constexpr unsigned int RX_THREADS = 1;
+
+  // Timestamps de recepção e de transmissão registrados pelo kernel
+  // (SO_TIMESTAMPING), no lugar do relógio lido pela thread de recepção
+  static constexpr bool TIMESTAMPING = true;
+  // Usa os timestamps da placa quando ela os suporta. O relógio da placa
+  // (PHC) precisa estar sincronizado com o do sistema (ex.: phc2sys).
+  static constexpr bool HW_TIMESTAMPING = false;
+  // Tempo máximo (ms) de espera pelo timestamp de transmissão
+  static constexpr int TX_TIMESTAMP_TIMEOUT_MS = 5;
+
+  // Cada thread que envia abre, no primeiro envio, o seu próprio socket de
+  // transmissão na interface, em vez de todas disputarem a trava do socket
+  // de recepção no kernel. A recepção não muda.
+  static constexpr bool PER_THREAD_TX = false;
+};
+
+template <typename DataWrapper, typename Config = DefaultEngineConfig>
 class Engine {
 public:
   using FrameClass = DataWrapper;
   using Frame = typename FrameClass::Frame;
 
+  // Tamanho da rajada usada pela NIC ao drenar o socket
+  static constexpr unsigned int RECEIVE_BURST = Config::RX_BURST;
+  // Quantidade máxima de mensagens por chamada de recvmmsg/sendmmsg
+  static constexpr unsigned int MAX_BURST = 64;
+  // Quantidade de filas (socket + thread) de recepção
+  static constexpr unsigned int RX_THREADS = Config::RX_THREADS;
+  static_assert(RX_THREADS >= 1, "Engine precisa de ao menos uma fila");
+  // Espaço de controle para um SCM_TIMESTAMPING por mensagem
+  static constexpr size_t TS_CONTROL_SIZE =
+      CMSG_SPACE(sizeof(struct scm_timestamping));
+
 public:
   // Construtor: Cria e configura o socket raw.
   Engine(const char *interface_name)
-      : _interface_name(interface_name), newMessage(false),
-        _thread_running(true), engine_lock(engine_lock_mutex) {
-    _self = this;
+      : _interface_name(interface_name) {
+    for (unsigned int q = 0; q < RX_THREADS; q++) {
+      _rx_fds[q] = -1;
+      _epoll_fds[q] = -1;
+    }
     // AF_PACKET para receber pacotes incluindo cabeçalhos da camada de enlace
     // SOCK_RAW para criar um raw socket
     _socket_raw = socket(AF_PACKET, SOCK_RAW, htons(ETH_P_ALL));
@@ -50,35 +142,8 @@ public:
       exit(EXIT_FAILURE);
     }
 
-    // Declara filtro BPF
-    // Para adicionar mais protocolos, verificar documentação do BPF:
-    // https://www.kernel.org/doc/Documentation/networking/filter.txt
-    struct sock_filter bpf_code[] = {
-      // Verifica o ethertype (ex: 0x88B5)
-      { 0x28, 0, 0, 0x0000000c }, // ldh [12] (Load half word into A)
-      { 0x15, 0, 1, 0x000088b5 }, // jeq 0x88B5? Se não, pula 1 instrução
-      { 0x06, 0, 0, 0x0000ffff }, // Retorna o quadro
-      { 0x06, 0, 0, 0x00000000 }, // Descarta quadro
-    };
-
-    struct sock_fprog bpf_prog = {
-      .len = sizeof(bpf_code) / sizeof(bpf_code[0]),
-      .filter = bpf_code,
-    };
-
-    // Tenta aplicar filtro
-    if (setsockopt(Engine::getSocketFd(), SOL_SOCKET, SO_ATTACH_FILTER,
-                   &bpf_prog, sizeof(bpf_prog))) {
-      perror("setsockopt");
-      exit(1);
-    }
-
-    int tam = 50 * 1024 * 1024;
-
-    if (setsockopt(Engine::getSocketFd(), SOL_SOCKET, SO_RCVBUFFORCE, &tam,
-                   sizeof(tam)) < 0) {
-      perror("setsockopt SO_RCVBUF");
-    }
+    _rx_fds[0] = _socket_raw;
+    setupRxSocket(0);
 
     int broadcastEnable = 1;
     if (setsockopt(Engine::getSocketFd(), SOL_SOCKET, SO_BROADCAST,
@@ -93,9 +158,7 @@ public:
       exit(EXIT_FAILURE);
     }
 
-    confSignalReception();
-
-    setupSignalHandler();
+    confSocket();
 
     // Bind no socket de receive
     struct sockaddr_ll sll_receive;
@@ -109,6 +172,21 @@ public:
       exit(EXIT_FAILURE);
     }
 
+    if constexpr (RX_THREADS > 1) {
+      setupFanout();
+    }
+
+    if constexpr (Config::TX_RING) {
+      setupTxRing();
+    }
+
+    if constexpr (Config::TIMESTAMPING) {
+      if constexpr (Config::HW_TIMESTAMPING) {
+        setupHwTimestamping();
+      }
+      setupStampSocket();
+    }
+
     turnRecvOn();
 #ifdef DEBUG
     // Print Debug -------------------------------------------------------
@@ -124,21 +202,73 @@ public:
 
   // Destrutor: Fecha o socket.
   ~Engine() {
-    stopRecv();
-    if (recvThread.joinable()) {
-      recvThread.join();
+    stopReceiving();
+
+    // _rx_fds[0] é o próprio _socket_raw
+    for (unsigned int q = 1; q < RX_THREADS; q++) {
+      if (_rx_fds[q] != -1) {
+        close(_rx_fds[q]);
+      }
     }
 
     if (_socket_raw != -1) {
       close(_socket_raw);
     }
 
+    if (_socket_tx != -1) {
+      close(_socket_tx);
+    }
+
+    if (_socket_stamp != -1) {
+      close(_socket_stamp);
+    }
+
+    for (int fd : _thread_tx_fds) {
+      close(fd);
+    }
+
+    for (int epoll_fd : _epoll_fds) {
+      if (epoll_fd != -1) {
+        close(epoll_fd);
+      }
+    }
+
+    if (_stop_fd != -1) {
+      close(_stop_fd);
+    }
+
 #ifdef DEBUG
     std::cout << "Engine for interface " << _interface_name << " destroyed."
               << std::endl;
 #endif
   }
 
+  // Substitui o filtro BPF do socket por um que, além do ethertype, descarta
+  // no kernel os quadros originados pelo próprio sistema (capturados na
+  // saída) e os destinados a outros sistemas. Os SysIDs são lidos do quadro
+  // como inteiros de 32 bits na ordem do host.
+  // Args:
+  //   origin_offset: Deslocamento do SysID de origem a partir do início do
+  //   quadro.
+  //   dest_offset: Deslocamento do SysID de destino a partir do início do
+  //   quadro.
+  //   own: SysID local.
+  //   accepted: SysIDs de destino aceitos além do local (ex.: broadcasts).
+  void filterSysID(unsigned int origin_offset, unsigned int dest_offset,
+                   int32_t own, std::initializer_list<int32_t> accepted) {
+    std::vector<struct sock_filter> bpf_code = EngineHelpers::sysIDFilter(
+        0, 0x88b5, origin_offset, dest_offset, own, accepted);
+    for (int fd : _rx_fds) {
+      EngineHelpers::attachFilter(fd, bpf_code);
+    }
+
+    // Todos os sistemas do host compartilham o MAC da interface: distribui
+    // as filas pelo SysID de origem
+    if constexpr (RX_THREADS > 1) {
+      setFanoutKey(origin_offset);
+    }
+  }
+
   // Envia dados usando um buffer pré-preenchido.
   // Args:
   //   buf: Ponteiro para o Buffer contendo os dados a serem enviados.
@@ -150,6 +280,23 @@ public:
     if (!buf)
       return -1; // Validação básica
 
+    if constexpr (Config::TX_RING) {
+      // Quadro já está no slot do anel: só marca para envio
+      if (buf->is_attached() &&
+          _tx_ring.owns(buf->template data<std::byte>())) {
+#ifdef DEBUG_DELAY
+        GlobalTimestamps &glob = GlobalTimestamps::getInstance();
+        auto now = std::chrono::high_resolution_clock::now();
+        int64_t down_delay = std::chrono::duration_cast<std::chrono::microseconds>(now.time_since_epoch()).count();
+        glob.addTopDownDelay(buf->_temp_top_delay, down_delay);
+#endif
+        if (_tx_ring.submit(buf->ext_ctx(), buf->size()) && kickTx() < 0) {
+          return -1;
+        }
+        return buf->size();
+      }
+    }
+
     // Configura o endereço de destino para sendto
     struct sockaddr_ll sadr_ll;
     std::memset(&sadr_ll, 0, sizeof(sadr_ll));
@@ -164,7 +311,7 @@ public:
     int64_t down_delay = std::chrono::duration_cast<std::chrono::microseconds>(now.time_since_epoch()).count();
     glob.addTopDownDelay(buf->_temp_top_delay, down_delay);
 #endif
-    int send_len = sendto(_socket_raw, buf->template data<Frame>(), buf->size(),
+    int send_len = sendto(txSocket(), buf->template data<Frame>(), buf->size(),
                           0, (const sockaddr *)&sadr_ll, sizeof(sadr_ll));
     if (send_len < 0) {
 #ifdef DEBUG
@@ -175,24 +322,142 @@ public:
     return send_len;
   }
 
+  // Envia uma rajada de buffers pré-preenchidos. Quadros montados no anel de
+  // transmissão são marcados para envio e os demais vão juntos em chamadas
+  // de sendmmsg.
+  // Args:
+  //   bufs: Vetor de ponteiros para os buffers a serem enviados.
+  //   n: Quantidade de buffers no vetor.
+  // Returns:
+  //   Quantidade de quadros enviados, sempre os primeiros do vetor, ou -1 se
+  //   nenhum pôde ser enviado por erro.
+  int send_burst(Buffer **bufs, int n) {
+    if (!bufs || n <= 0)
+      return -1;
+
+    struct mmsghdr msgs[MAX_BURST];
+    struct iovec iovs[MAX_BURST];
+    struct sockaddr_ll addrs[MAX_BURST];
+
+    int sent = 0;
+    bool kick = false;
+    while (sent < n) {
+      if constexpr (Config::TX_RING) {
+        Buffer *buf = bufs[sent];
+        if (buf->is_attached() &&
+            _tx_ring.owns(buf->template data<std::byte>())) {
+          kick |= _tx_ring.submit(buf->ext_ctx(), buf->size());
+          sent++;
+          continue;
+        }
+      }
+
+      // Agrupa os próximos quadros que não estão no anel
+      unsigned int count = 0;
+      while (sent + (int)count < n && count < MAX_BURST) {
+        Buffer *buf = bufs[sent + count];
+        if constexpr (Config::TX_RING) {
+          if (buf->is_attached() &&
+              _tx_ring.owns(buf->template data<std::byte>())) {
+            break;
+          }
+        }
+        std::memset(&addrs[count], 0, sizeof(addrs[count]));
+        addrs[count].sll_family = AF_PACKET;
+        addrs[count].sll_ifindex = _interface_index;
+        addrs[count].sll_halen = ETH_ALEN;
+        std::memcpy(addrs[count].sll_addr,
+                    buf->template data<Frame>()->dst.mac, ETH_ALEN);
+        iovs[count].iov_base = buf->template data<Frame>();
+        iovs[count].iov_len = buf->size();
+        std::memset(&msgs[count], 0, sizeof(msgs[count]));
+        msgs[count].msg_hdr.msg_name = &addrs[count];
+        msgs[count].msg_hdr.msg_namelen = sizeof(addrs[count]);
+        msgs[count].msg_hdr.msg_iov = &iovs[count];
+        msgs[count].msg_hdr.msg_iovlen = 1;
+        count++;
+      }
+
+      int ret = sendmmsg(txSocket(), msgs, count, 0);
+      if (ret < 0) {
+#ifdef DEBUG
+        perror("Engine::send_burst sendmmsg error");
+#endif
+        break;
+      }
+      sent += ret;
+      if (ret < (int)count) {
+        break;
+      }
+    }
+
+    if constexpr (Config::TX_RING) {
+      if (kick) {
+        kickTx();
+      }
+    }
+    return sent > 0 ? sent : -1;
+  }
+
+  // Envia um quadro e obtém o instante em que ele deixou a pilha de rede,
+  // registrado pelo kernel (SO_TIMESTAMPING) e lido da fila de erros do
+  // socket de timestamps. Usado nas mensagens de sincronização.
+  // Args:
+  //   buf: Ponteiro para o Buffer contendo os dados a serem enviados.
+  //   tx_time: Recebe o instante de transmissão (us, relógio do sistema), ou
+  //   0 se o kernel não o informou a tempo.
+  // Returns:
+  //   Número de bytes enviados ou -1 em caso de erro.
+  int send_timestamped(Buffer *buf, int64_t &tx_time) {
+    tx_time = 0;
+    if constexpr (!Config::TIMESTAMPING) {
+      return send(buf);
+    }
+    if (!buf)
+      return -1;
+
+    struct sockaddr_ll sadr_ll;
+    std::memset(&sadr_ll, 0, sizeof(sadr_ll));
+    sadr_ll.sll_family = AF_PACKET;
+    sadr_ll.sll_ifindex = _interface_index;
+    sadr_ll.sll_halen = ETH_ALEN;
+    std::memcpy(sadr_ll.sll_addr, buf->template data<Frame>()->dst.mac,
+                ETH_ALEN);
+
+    // Um envio por vez, para que o timestamp lido seja o deste quadro
+    std::lock_guard<std::mutex> lock(_stamp_mtx);
+    // Descarta timestamps que chegaram depois do prazo em envios anteriores
+    while (readTxTimestamp(0) != -1) {
+    }
+    // Quadros montados no anel de transmissão também são enviados por aqui;
+    // o slot não usado é devolvido quando a NIC libera o buffer
+    int send_len = sendto(_socket_stamp, buf->template data<Frame>(),
+                          buf->size(), 0, (const sockaddr *)&sadr_ll,
+                          sizeof(sadr_ll));
+    if (send_len < 0) {
+#ifdef DEBUG
+      perror("Engine::send_timestamped sendto error");
+#endif
+      return -1;
+    }
+    // Se o driver não registra timestamps de transmissão, deixa de esperar
+    // por eles após algumas tentativas
+    int timeout = _tx_stamp_misses < MAX_TX_STAMP_MISSES
+                      ? Config::TX_TIMESTAMP_TIMEOUT_MS
+                      : 0;
+    int64_t stamp = readTxTimestamp(timeout);
+    tx_time = stamp > 0 ? stamp : 0;
+    _tx_stamp_misses = tx_time != 0 ? 0 : _tx_stamp_misses + 1;
+    return send_len;
+  }
+
   // Obtém informações da interface (MAC, índice) usando ioctl.
   bool get_interface_info() {
-    struct ifreq ifr;
-    std::memset(&ifr, 0, sizeof(ifr));
-    strncpy(ifr.ifr_name, _interface_name, IFNAMSIZ - 1);
-    ifr.ifr_name[IFNAMSIZ - 1] = '\0'; // Garante terminação nula
-
-    // Obter o endereço MAC (Hardware Address)
-    if (ioctl(Engine::getSocketFd(), SIOCGIFHWADDR, &ifr) == -1) {
+    if (EngineHelpers::interfaceInfo(_interface_name, _address) == 0) {
       perror("Engine Error: ioctl SIOCGIFHWADDR failed");
       return false;
     }
 
-    // Copia o endereço MAC da estrutura ifreq para o membro _address
-    // Usa o construtor de Address que recebe unsigned char[6]
-    _address = Ethernet::Address(
-        reinterpret_cast<const unsigned char *>(ifr.ifr_hwaddr.sa_data));
-
     // Caso a interface utilizada seja loopback, geralmente o endereço dela é
     // 00:00:00:00:00:00 Verifica se o MAC obtido não é zero
     if (strcmp(_interface_name, "lo") != 0 &&
@@ -213,93 +478,653 @@ public:
   //   Número de bytes recebidos, 0 se não houver dados (não bloqueante), ou -1
   //   em caso de erro real.
   int receive(Buffer *buf) {
+    if constexpr (Config::RX_RING) {
+      // Entrega o quadro no próprio anel, sem cópia. O bloco só volta ao
+      // kernel quando o buffer for devolvido com release().
+      int len = 0;
+      int block = -1;
+      int64_t timestamp = 0;
+      std::byte *frame = _rx_rings[_rx_queue].next(len, block, timestamp);
+      if (frame == nullptr) {
+        buf->setSize(0);
+        return 0;
+      }
+      buf->attach(frame, block);
+      buf->setSize(len);
+      if constexpr (Config::TIMESTAMPING) {
+        buf->set_kernel_time(timestamp);
+      }
+      return len;
+    }
+
     struct sockaddr_ll sender_addr;
-    socklen_t sender_addr_len = sizeof(sender_addr);
+    struct iovec iov = { buf->template data<Frame>(),
+                         static_cast<size_t>(buf->maxSize()) };
+    [[maybe_unused]] alignas(struct cmsghdr) char control[TS_CONTROL_SIZE];
+    struct msghdr msg;
+    std::memset(&msg, 0, sizeof(msg));
+    msg.msg_name = &sender_addr;
+    msg.msg_namelen = sizeof(sender_addr);
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    if constexpr (Config::TIMESTAMPING) {
+      msg.msg_control = control;
+      msg.msg_controllen = sizeof(control);
+    }
 
-    int buflen = recvfrom(_self->_socket_raw, buf->template data<Frame>(),
-                          buf->maxSize(), 0, (struct sockaddr *)&sender_addr,
-                          (socklen_t *)&sender_addr_len);
+    int buflen = recvmsg(_rx_fds[_rx_queue], &msg, 0);
     if (buflen < 0) {
       // Erro real ou apenas indicação de não bloqueio?
       if (errno == EWOULDBLOCK || errno == EAGAIN) {
         buf->setSize(0); // Nenhum dado recebido agora
         return 0;        // Não é um erro fatal em modo não bloqueante
       } else {
-        perror("Engine::receive recvfrom error");
+        perror("Engine::receive recvmsg error");
         buf->setSize(0); // Indica erro zerando o tamanho
         return -1;       // Erro real
       }
     } else {
       // Dados recebidos com sucesso, ajusta o tamanho real do buffer.
       buf->setSize(buflen);
+      if constexpr (Config::TIMESTAMPING) {
+        buf->set_kernel_time(kernelTime(&msg));
+      }
       return buflen;
     }
     return buflen;
   }
-  // Configura o handler de sinal (SIGIO).
+
+  // Recebe uma rajada de quadros com uma única chamada de sistema
+  // (recvmmsg), ou percorrendo o anel quando Config::RX_RING.
   // Args:
-  //   func: Função que tratará o sinal.
-  void setupSignalHandler() {
-    // Armazena a função de callback
-    struct sigaction sigAction;
-    sigAction.sa_handler = Engine::signalHandler;
-    sigAction.sa_flags = SA_RESTART;
-
-    // Limpa possiveis sinais existentes antes da configuracao
-    sigemptyset(&sigAction.sa_mask);
-
-    // Configura sigaction
-    // nullptr indica que nao queremos salvar a sigaction anterior
-    if (sigaction(SIGIO, &sigAction, nullptr) < 0) {
-      perror("sigaction");
-      exit(EXIT_FAILURE);
+  //   bufs: Vetor de buffers pré-alocados que receberão os quadros.
+  //   n: Quantidade de buffers no vetor.
+  // Returns:
+  //   Quantidade de quadros recebidos (os primeiros do vetor), 0 se não houver
+  //   dados ou -1 em caso de erro real.
+  int receive_burst(Buffer **bufs, int n) {
+    if constexpr (Config::RX_RING) {
+      int received = 0;
+      while (received < n && receive(bufs[received]) > 0) {
+        received++;
+      }
+      return received;
+    }
+
+    struct mmsghdr msgs[MAX_BURST];
+    struct iovec iovs[MAX_BURST];
+    [[maybe_unused]] alignas(struct cmsghdr) char
+        controls[MAX_BURST][TS_CONTROL_SIZE];
+    if (n > (int)MAX_BURST) {
+      n = MAX_BURST;
+    }
+    for (int i = 0; i < n; i++) {
+      iovs[i].iov_base = bufs[i]->template data<Frame>();
+      iovs[i].iov_len = bufs[i]->maxSize();
+      std::memset(&msgs[i], 0, sizeof(msgs[i]));
+      msgs[i].msg_hdr.msg_iov = &iovs[i];
+      msgs[i].msg_hdr.msg_iovlen = 1;
+      if constexpr (Config::TIMESTAMPING) {
+        msgs[i].msg_hdr.msg_control = controls[i];
+        msgs[i].msg_hdr.msg_controllen = TS_CONTROL_SIZE;
+      }
+    }
+
+    int received = recvmmsg(_rx_fds[_rx_queue], msgs, n, MSG_DONTWAIT, nullptr);
+    if (received < 0) {
+      if (errno == EWOULDBLOCK || errno == EAGAIN) {
+        return 0;
+      }
+      perror("Engine::receive_burst recvmmsg error");
+      return -1;
+    }
+    for (int i = 0; i < received; i++) {
+      bufs[i]->setSize(msgs[i].msg_len);
+      if constexpr (Config::TIMESTAMPING) {
+        bufs[i]->set_kernel_time(kernelTime(&msgs[i].msg_hdr));
+      }
+    }
+    return received;
+  }
+
+  // Devolve à Engine um quadro entregue por receive() sem cópia.
+  // Args:
+  //   buf: Buffer associado (attach) a um quadro do anel.
+  void release(Buffer *buf) {
+    if constexpr (Config::TX_RING) {
+      if (_tx_ring.owns(buf->template data<std::byte>())) {
+        // Slot reservado e não enviado é descartado para não travar o anel
+        if (_tx_ring.discard(buf->ext_ctx())) {
+          kickTx();
+        }
+        buf->detach();
+        return;
+      }
+    }
+    if constexpr (Config::RX_RING) {
+      // O quadro pode ter vindo do anel de qualquer fila
+      for (RxRing &ring : _rx_rings) {
+        if (ring.owns(buf->template data<std::byte>())) {
+          ring.release(buf->ext_ctx());
+          break;
+        }
+      }
+    }
+    buf->detach();
+  }
+
+  // Associa um buffer de envio a um slot livre do anel de transmissão, para
+  // que o quadro seja montado diretamente na memória enviada pelo kernel.
+  // Args:
+  //   buf: Buffer recém alocado do pool de envio.
+  // Returns:
+  //   true se o buffer foi associado; false se o anel estiver cheio (o buffer
+  //   continua usando sua área interna e o envio cai no sendto).
+  bool reserve(Buffer *buf) {
+    if constexpr (Config::TX_RING) {
+      int slot = -1;
+      std::byte *frame = _tx_ring.reserve(slot);
+      if (frame == nullptr) {
+        return false;
+      }
+      buf->attach(frame, slot);
+      return true;
     }
+    return false;
   }
 
   int getSocketFd() const {
     return _socket_raw;
   }
 
+  // Quadros descartados pelo kernel (ex.: fila do socket ou anel cheio)
+  // desde a última chamada, somando todas as filas (PACKET_STATISTICS zera
+  // os contadores a cada leitura).
+  unsigned long long kernelDrops() {
+    unsigned long long drops = 0;
+    for (unsigned int q = 0; q < RX_THREADS; q++) {
+      // tpacket_stats_v3 começa com os campos de tpacket_stats
+      struct tpacket_stats_v3 stats = {};
+      socklen_t len = sizeof(stats);
+      if (getsockopt(_rx_fds[q], SOL_PACKET, PACKET_STATISTICS, &stats,
+                     &len) == 0) {
+        drops += stats.tp_drops;
+      }
+    }
+    return drops;
+  }
+
+  // Encerra as threads de recepção. Usado por quem precisa parar a entrega
+  // de quadros antes de destruir o próprio estado (ex.: pools da NIC).
+  void stopReceiving() {
+    stopRecv();
+    for (std::thread &thread : _rx_threads) {
+      if (thread.joinable()) {
+        thread.join();
+      }
+    }
+  }
+
+  // Fila de recepção atendida pela thread atual (0 fora das threads de
+  // recepção). Permite ao tratador saber por qual fila do PACKET_FANOUT um
+  // quadro chegou (ex.: contagem por fila no perf_fanout_test).
+  static unsigned int rxQueue() {
+    return _rx_queue;
+  }
+
 public:
   const Ethernet::Address &getAddress() {
     return _address;
   }
 
   template <typename T, void (T::*handle_signal)()>
-  static void bind(T *obj) {
-    _self->obj = obj;
-    _self->handler = &handlerWrapper<T, handle_signal>;
+  void bind(T *obj) {
+    _obj = obj;
+    _handler = &handlerWrapper<T, handle_signal>;
+    // O socket só entra no epoll depois que há quem trate os quadros. Se já
+    // houver dados pendentes, o EPOLL_CTL_ADD gera o primeiro evento.
+    watchSocket();
   }
 
 private:
+  // Acorda a thread de recepção pelo eventfd para que ela termine.
   void stopRecv() {
-    pthread_mutex_lock(&_threadStopMutex);
-    _thread_running = 0;
-    pthread_mutex_unlock(&_threadStopMutex);
-    if (engine_lock.owns_lock()) {
-      engine_lock.unlock();
+    _running.store(false, std::memory_order_relaxed);
+    uint64_t one = 1;
+    if (_stop_fd != -1 && write(_stop_fd, &one, sizeof(one)) < 0) {
+      perror("write eventfd");
+    }
+  }
+
+  // Registra cada socket no epoll da sua fila em modo edge-triggered: cada
+  // chegada de quadros gera um evento e o handler drena o socket até EAGAIN.
+  void watchSocket() {
+    for (unsigned int q = 0; q < RX_THREADS; q++) {
+      struct epoll_event ev;
+      std::memset(&ev, 0, sizeof(ev));
+      ev.events = EPOLLIN | EPOLLET;
+      ev.data.fd = _rx_fds[q];
+      if (epoll_ctl(_epoll_fds[q], EPOLL_CTL_ADD, _rx_fds[q], &ev) < 0) {
+        perror("epoll_ctl (socket)");
+        exit(EXIT_FAILURE);
+      }
     }
-    engine_cond.notify_one();
   }
 
+  // Cria um epoll por fila, todos com o eventfd de parada, e dispara uma
+  // thread de recepção por fila, que chama o handler da NIC diretamente a
+  // cada evento do seu socket.
   void turnRecvOn() {
-    recvThread = std::thread([this]() {
-      std::cout << "Processo " << getpid() << ", thread de recebimento: " << gettid() << std::endl;
-      while (true) {
-        engine_cond.wait(engine_lock, [this]() {
-          // Só desbloqueia se o bind já aconteceu e chegou uma nova mensagem
-          // Ou se a thread deve parar de executar
-          return (obj != nullptr && newMessage) || !_thread_running;
-        });
-        pthread_mutex_lock(&_threadStopMutex);
-        if (!_thread_running) {
-          break;
+    _stop_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (_stop_fd < 0) {
+      perror("eventfd");
+      exit(EXIT_FAILURE);
+    }
+    for (unsigned int q = 0; q < RX_THREADS; q++) {
+      _epoll_fds[q] = epoll_create1(EPOLL_CLOEXEC);
+      if (_epoll_fds[q] < 0) {
+        perror("epoll_create1");
+        exit(EXIT_FAILURE);
+      }
+      // O eventfd nunca é lido: uma única escrita acorda todas as filas
+      struct epoll_event ev;
+      std::memset(&ev, 0, sizeof(ev));
+      ev.events = EPOLLIN;
+      ev.data.fd = _stop_fd;
+      if (epoll_ctl(_epoll_fds[q], EPOLL_CTL_ADD, _stop_fd, &ev) < 0) {
+        perror("epoll_ctl (eventfd)");
+        exit(EXIT_FAILURE);
+      }
+    }
+
+    for (unsigned int q = 0; q < RX_THREADS; q++) {
+      _rx_threads[q] = std::thread([this, q]() { recvLoop(q); });
+    }
+  }
+
+  // Laço da thread de recepção de uma fila.
+  // Args:
+  //   q: Índice da fila (socket e epoll) atendida pela thread.
+  void recvLoop(unsigned int q) {
+    _rx_queue = q;
+    std::cout << "Processo " << getpid() << ", thread de recebimento: " << gettid() << std::endl;
+    struct epoll_event events[2];
+    while (true) {
+      int n = epoll_wait(_epoll_fds[q], events, 2, -1);
+      if (n < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        perror("epoll_wait");
+        break;
+      }
+      bool readable = false;
+      for (int i = 0; i < n; i++) {
+        if (events[i].data.fd == _stop_fd) {
+          return;
+        }
+        readable = true;
+      }
+      if (readable) {
+        _handler(_obj);
+        if constexpr (Config::RX_POLICY != RxPolicy::Blocking) {
+          if (!spin()) {
+            return;
+          }
+        }
+      }
+    }
+  }
+
+  // Continua consultando o socket sem dormir, tratando os quadros que
+  // chegarem. Na política Adaptive desiste após Config::RX_SPIN_US sem
+  // quadros; na BusyPoll só para quando a Engine é destruída.
+  // Returns:
+  //   false se a thread de recepção deve terminar.
+  bool spin() {
+    using clock = std::chrono::steady_clock;
+    constexpr auto budget = std::chrono::microseconds(Config::RX_SPIN_US);
+    auto deadline = clock::now() + budget;
+    while (_running.load(std::memory_order_relaxed)) {
+      if (pending()) {
+        _handler(_obj);
+        if constexpr (Config::RX_POLICY == RxPolicy::Adaptive) {
+          deadline = clock::now() + budget;
+        }
+      } else if constexpr (Config::RX_POLICY == RxPolicy::Adaptive) {
+        if (clock::now() >= deadline) {
+          return true;
+        }
+      }
+    }
+    return false;
+  }
+
+  // Indica se há quadros esperando no socket (ou no anel) da fila da thread
+  // atual, sem consumi-los.
+  bool pending() {
+    if constexpr (Config::RX_RING) {
+      return _rx_rings[_rx_queue].pending();
+    }
+    std::byte peek;
+    return recv(_rx_fds[_rx_queue], &peek, sizeof(peek),
+                MSG_PEEK | MSG_DONTWAIT | MSG_TRUNC) >= 0;
+  }
+
+  // Ativa o busy polling do driver nas leituras do socket.
+  // Args:
+  //   fd: Socket de recepção.
+  void setupBusyPoll(int fd) {
+    int usecs = Config::RX_BUSY_POLL_US;
+    if (setsockopt(fd, SOL_SOCKET, SO_BUSY_POLL, &usecs,
+                   sizeof(usecs)) < 0) {
+      perror("setsockopt SO_BUSY_POLL");
+    }
+#ifdef SO_PREFER_BUSY_POLL
+    int prefer = 1;
+    if (setsockopt(fd, SOL_SOCKET, SO_PREFER_BUSY_POLL, &prefer,
+                   sizeof(prefer)) < 0) {
+      perror("setsockopt SO_PREFER_BUSY_POLL");
+    }
+#endif
+  }
+
+  // Aplica ao socket de uma fila as opções de recepção: filtro BPF inicial,
+  // anel de recepção, tamanho do buffer e busy polling. Deve ser chamado
+  // antes do bind.
+  // Args:
+  //   q: Índice da fila cujo socket (_rx_fds[q]) será configurado.
+  void setupRxSocket(unsigned int q) {
+    int fd = _rx_fds[q];
+
+    // Declara filtro BPF
+    // Para adicionar mais protocolos, verificar documentação do BPF:
+    // https://www.kernel.org/doc/Documentation/networking/filter.txt
+    struct sock_filter bpf_code[] = {
+      // Verifica o ethertype (ex: 0x88B5)
+      { 0x28, 0, 0, 0x0000000c }, // ldh [12] (Load half word into A)
+      { 0x15, 0, 1, 0x000088b5 }, // jeq 0x88B5? Se não, pula 1 instrução
+      { 0x06, 0, 0, 0x0000ffff }, // Retorna o quadro
+      { 0x06, 0, 0, 0x00000000 }, // Descarta quadro
+    };
+
+    struct sock_fprog bpf_prog = {
+      .len = sizeof(bpf_code) / sizeof(bpf_code[0]),
+      .filter = bpf_code,
+    };
+
+    // Tenta aplicar filtro
+    if (setsockopt(fd, SOL_SOCKET, SO_ATTACH_FILTER,
+                   &bpf_prog, sizeof(bpf_prog))) {
+      perror("setsockopt");
+      exit(1);
+    }
+
+    // O anel precisa ser configurado antes do bind
+    if constexpr (Config::RX_RING) {
+      if (!_rx_rings[q].setup(fd, Config::RX_BLOCK_SIZE,
+                              Config::RX_BLOCK_COUNT, Config::RX_FRAME_SIZE,
+                              Config::RX_BLOCK_TIMEOUT)) {
+        perror("setsockopt PACKET_RX_RING");
+        exit(EXIT_FAILURE);
+      }
+    }
+
+    if constexpr (Config::TIMESTAMPING) {
+      int flags = rxTimestampFlags();
+      if (setsockopt(fd, SOL_SOCKET, SO_TIMESTAMPING, &flags,
+                     sizeof(flags)) < 0) {
+        perror("setsockopt SO_TIMESTAMPING");
+      }
+      // No anel, o timestamp vai no cabeçalho de cada quadro
+      if constexpr (Config::RX_RING && Config::HW_TIMESTAMPING) {
+        int ring_flags = SOF_TIMESTAMPING_RAW_HARDWARE;
+        if (setsockopt(fd, SOL_PACKET, PACKET_TIMESTAMP, &ring_flags,
+                       sizeof(ring_flags)) < 0) {
+          perror("setsockopt PACKET_TIMESTAMP");
         }
-        pthread_mutex_unlock(&_threadStopMutex);
-        _self->handler(_self->obj);
-        newMessage = false;
       }
-    });
+    }
+
+    int tam = 50 * 1024 * 1024;
+
+    if (setsockopt(fd, SOL_SOCKET, SO_RCVBUFFORCE, &tam,
+                   sizeof(tam)) < 0) {
+      perror("setsockopt SO_RCVBUF");
+    }
+
+    if constexpr (Config::RX_POLICY == RxPolicy::BusyPoll) {
+      setupBusyPoll(fd);
+    }
+  }
+
+  // Cria os sockets das demais filas e coloca todos em um grupo
+  // PACKET_FANOUT do tipo CBPF: um programa BPF escolhe a fila de cada
+  // quadro a partir de uma palavra do quadro (ver setFanoutKey).
+  void setupFanout() {
+    for (unsigned int q = 1; q < RX_THREADS; q++) {
+      _rx_fds[q] = socket(AF_PACKET, SOCK_RAW, htons(ETH_P_ALL));
+      if (_rx_fds[q] == -1) {
+        perror("socket creation (fanout)");
+        exit(EXIT_FAILURE);
+      }
+      setupRxSocket(q);
+
+      int flags = fcntl(_rx_fds[q], F_GETFL);
+      if (flags < 0 || fcntl(_rx_fds[q], F_SETFL, flags | O_NONBLOCK) < 0) {
+        perror("fcntl (fanout)");
+        exit(EXIT_FAILURE);
+      }
+
+      struct sockaddr_ll sll;
+      std::memset(&sll, 0, sizeof(sll));
+      sll.sll_family = AF_PACKET;
+      sll.sll_protocol = htons(ETH_P_ALL);
+      sll.sll_ifindex = _interface_index;
+      if (::bind(_rx_fds[q], (struct sockaddr *)&sll, sizeof(sll)) < 0) {
+        perror("bind (fanout socket)");
+        exit(EXIT_FAILURE);
+      }
+    }
+
+    // O primeiro socket cria o grupo com um id único escolhido pelo kernel,
+    // para não misturar filas de processos diferentes
+    int arg = (PACKET_FANOUT_CBPF | PACKET_FANOUT_FLAG_UNIQUEID) << 16;
+    if (setsockopt(_rx_fds[0], SOL_PACKET, PACKET_FANOUT, &arg,
+                   sizeof(arg)) < 0) {
+      perror("setsockopt PACKET_FANOUT");
+      exit(EXIT_FAILURE);
+    }
+    socklen_t len = sizeof(arg);
+    if (getsockopt(_rx_fds[0], SOL_PACKET, PACKET_FANOUT, &arg, &len) < 0) {
+      perror("getsockopt PACKET_FANOUT");
+      exit(EXIT_FAILURE);
+    }
+    int group = (arg & 0xffff) | (PACKET_FANOUT_CBPF << 16);
+    for (unsigned int q = 1; q < RX_THREADS; q++) {
+      if (setsockopt(_rx_fds[q], SOL_PACKET, PACKET_FANOUT, &group,
+                     sizeof(group)) < 0) {
+        perror("setsockopt PACKET_FANOUT");
+        exit(EXIT_FAILURE);
+      }
+    }
+
+    // Até o protocolo informar o SysID, distribui pelo MAC de origem
+    // (últimos 4 bytes)
+    setFanoutKey(ETH_ALEN + 2);
+  }
+
+  // Troca o programa do grupo PACKET_FANOUT: a fila de cada quadro é obtida
+  // da palavra de 32 bits no deslocamento dado, com os bytes misturados (a
+  // chave pode estar em qualquer ordem de bytes) e módulo RX_THREADS.
+  // Quadros de uma mesma origem sempre caem na mesma fila, mantendo a ordem.
+  // Args:
+  //   offset: Deslocamento da chave a partir do início do quadro.
+  void setFanoutKey(unsigned int offset) {
+    struct sock_filter bpf_code[] = {
+      // No fan-out o quadro já está posicionado na camada de rede: a chave
+      // é lida relativa ao cabeçalho de enlace (SKF_LL_OFF)
+      BPF_STMT(BPF_LD | BPF_W | BPF_ABS, SKF_LL_OFF + offset),
+      // A ^= A >> 16; A ^= A >> 8
+      BPF_STMT(BPF_MISC | BPF_TAX, 0),
+      BPF_STMT(BPF_ALU | BPF_RSH | BPF_K, 16),
+      BPF_STMT(BPF_ALU | BPF_XOR | BPF_X, 0),
+      BPF_STMT(BPF_MISC | BPF_TAX, 0),
+      BPF_STMT(BPF_ALU | BPF_RSH | BPF_K, 8),
+      BPF_STMT(BPF_ALU | BPF_XOR | BPF_X, 0),
+      BPF_STMT(BPF_ALU | BPF_MOD | BPF_K, RX_THREADS),
+      BPF_STMT(BPF_RET | BPF_A, 0),
+    };
+    struct sock_fprog bpf_prog = {
+      .len = sizeof(bpf_code) / sizeof(bpf_code[0]),
+      .filter = bpf_code,
+    };
+    if (setsockopt(_rx_fds[0], SOL_PACKET, PACKET_FANOUT_DATA, &bpf_prog,
+                   sizeof(bpf_prog)) < 0) {
+      perror("setsockopt PACKET_FANOUT_DATA");
+      exit(EXIT_FAILURE);
+    }
+  }
+
+  // Extrai de uma mensagem recebida o timestamp SCM_TIMESTAMPING: o da placa
+  // quando Config::HW_TIMESTAMPING e disponível, senão o do software.
+  // Args:
+  //   msg: Mensagem com o espaço de controle preenchido pelo kernel.
+  // Returns:
+  //   Instante registrado pelo kernel (us, relógio do sistema) ou 0.
+  static int64_t kernelTime(struct msghdr *msg) {
+    return EngineHelpers::kernelTime(msg, Config::HW_TIMESTAMPING);
+  }
+
+  // Lê um timestamp de transmissão da fila de erros do socket de
+  // timestamps.
+  // Args:
+  //   timeout_ms: Tempo máximo de espera; 0 apenas consulta a fila.
+  // Returns:
+  //   Instante de transmissão (us), 0 se a mensagem não trazia timestamp ou
+  //   -1 se a fila estava vazia.
+  int64_t readTxTimestamp(int timeout_ms) {
+    // POLLERR é sempre reportado: indica mensagem na fila de erros
+    struct pollfd pfd = { _socket_stamp, 0, 0 };
+    if (poll(&pfd, 1, timeout_ms) <= 0) {
+      return -1;
+    }
+    alignas(struct cmsghdr) char control[256];
+    struct msghdr msg;
+    std::memset(&msg, 0, sizeof(msg));
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+    if (recvmsg(_socket_stamp, &msg, MSG_ERRQUEUE | MSG_DONTWAIT) < 0) {
+      return -1;
+    }
+    return kernelTime(&msg);
+  }
+
+  // Flags de SO_TIMESTAMPING dos sockets de recepção.
+  static constexpr int rxTimestampFlags() {
+    int flags = SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE;
+    if constexpr (Config::HW_TIMESTAMPING) {
+      flags |= SOF_TIMESTAMPING_RX_HARDWARE | SOF_TIMESTAMPING_RAW_HARDWARE;
+    }
+    return flags;
+  }
+
+  // Socket usado pelos envios da thread atual: o socket raw da Engine ou,
+  // com Config::PER_THREAD_TX, o socket próprio da thread, aberto no
+  // primeiro envio. Cada thread guarda os seus sockets pelo identificador
+  // da Engine, que nunca se repete, então sockets de Engines já destruídas
+  // nunca são usados.
+  int txSocket() {
+    if constexpr (!Config::PER_THREAD_TX) {
+      return _socket_raw;
+    } else {
+      static thread_local std::vector<std::pair<uint64_t, int>> sockets;
+      for (const auto &[id, fd] : sockets) {
+        if (id == _instance_id) {
+          return fd;
+        }
+      }
+      int fd = openTxSocket();
+      if (fd == -1) {
+        return _socket_raw;
+      }
+      sockets.emplace_back(_instance_id, fd);
+      return fd;
+    }
+  }
+
+  // Abre um socket de transmissão com protocolo 0 (não recebe quadros),
+  // ligado à interface e não bloqueante como o socket raw. Fechado pelo
+  // destrutor da Engine.
+  // Returns:
+  //   O socket, ou -1 em caso de erro.
+  int openTxSocket() {
+    int fd = socket(AF_PACKET, SOCK_RAW | SOCK_NONBLOCK, 0);
+    if (fd == -1) {
+      perror("socket creation (thread tx)");
+      return -1;
+    }
+    struct sockaddr_ll sll;
+    std::memset(&sll, 0, sizeof(sll));
+    sll.sll_family = AF_PACKET;
+    sll.sll_protocol = 0;
+    sll.sll_ifindex = _interface_index;
+    if (::bind(fd, (struct sockaddr *)&sll, sizeof(sll)) < 0) {
+      perror("bind (thread tx socket)");
+      close(fd);
+      return -1;
+    }
+    std::lock_guard<std::mutex> lock(_thread_tx_mtx);
+    _thread_tx_fds.push_back(fd);
+    return fd;
+  }
+
+  // Cria o socket usado por send_timestamped. Ele usa protocolo 0 (não
+  // recebe quadros) e só ele pede timestamps de transmissão, para que a
+  // fila de erros não acorde as threads de recepção.
+  void setupStampSocket() {
+    _socket_stamp = socket(AF_PACKET, SOCK_RAW, 0);
+    if (_socket_stamp == -1) {
+      perror("socket creation (timestamping)");
+      exit(EXIT_FAILURE);
+    }
+
+    struct sockaddr_ll sll;
+    std::memset(&sll, 0, sizeof(sll));
+    sll.sll_family = AF_PACKET;
+    sll.sll_protocol = 0;
+    sll.sll_ifindex = _interface_index;
+    if (::bind(_socket_stamp, (struct sockaddr *)&sll, sizeof(sll)) < 0) {
+      perror("bind (timestamping socket)");
+      exit(EXIT_FAILURE);
+    }
+
+    // OPT_TSONLY: a fila de erros traz só o timestamp, sem cópia do quadro
+    int flags = SOF_TIMESTAMPING_TX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE |
+                SOF_TIMESTAMPING_OPT_TSONLY;
+    if constexpr (Config::HW_TIMESTAMPING) {
+      flags |= SOF_TIMESTAMPING_TX_HARDWARE | SOF_TIMESTAMPING_RAW_HARDWARE;
+    }
+    if (setsockopt(_socket_stamp, SOL_SOCKET, SO_TIMESTAMPING, &flags,
+                   sizeof(flags)) < 0) {
+      perror("setsockopt SO_TIMESTAMPING (tx)");
+    }
+  }
+
+  // Liga os timestamps de hardware da interface. Sem suporte da placa,
+  // continuam valendo os de software.
+  void setupHwTimestamping() {
+    struct hwtstamp_config config;
+    std::memset(&config, 0, sizeof(config));
+    config.tx_type = HWTSTAMP_TX_ON;
+    config.rx_filter = HWTSTAMP_FILTER_ALL;
+    struct ifreq ifr;
+    std::memset(&ifr, 0, sizeof(ifr));
+    strncpy(ifr.ifr_name, _interface_name, IFNAMSIZ - 1);
+    ifr.ifr_data = reinterpret_cast<char *>(&config);
+    if (ioctl(_socket_raw, SIOCSHWTSTAMP, &ifr) < 0) {
+      perror("ioctl SIOCSHWTSTAMP");
+    }
   }
 
   template <typename T, void (T::*handle_signal)()>
@@ -308,15 +1133,48 @@ private:
     (typedObj->*handle_signal)();
   }
 
-  // Configura a recepção de sinais SIGIO para o socket.
-  void confSignalReception() {
-    // Configura processo como ´dono´ do socket para poder receber
-    // sinais, como o SIGIO
-    if (fcntl(Engine::getSocketFd(), F_SETOWN, getpid()) < 0) {
-      perror("fcntl F_SETOWN");
+  // Cria o socket exclusivo de transmissão e configura o PACKET_TX_RING.
+  // O socket usa protocolo 0, então não recebe nenhum quadro.
+  void setupTxRing() {
+    _socket_tx = socket(AF_PACKET, SOCK_RAW, 0);
+    if (_socket_tx == -1) {
+      perror("socket creation (tx ring)");
       exit(EXIT_FAILURE);
     }
 
+    if (!_tx_ring.setup(_socket_tx, Config::TX_FRAME_SIZE,
+                        Config::TX_FRAME_COUNT)) {
+      perror("setsockopt PACKET_TX_RING");
+      exit(EXIT_FAILURE);
+    }
+
+    struct sockaddr_ll sll_send;
+    std::memset(&sll_send, 0, sizeof(sll_send));
+    sll_send.sll_family = AF_PACKET;
+    sll_send.sll_protocol = 0;
+    sll_send.sll_ifindex = _interface_index;
+    if (::bind(_socket_tx, (struct sockaddr *)&sll_send, sizeof(sll_send)) <
+        0) {
+      perror("bind (tx ring socket)");
+      exit(EXIT_FAILURE);
+    }
+  }
+
+  // Envia todos os slots marcados no anel de transmissão com uma única
+  // chamada de sistema.
+  int kickTx() {
+    int ret = sendto(_socket_tx, nullptr, 0, MSG_DONTWAIT, nullptr, 0);
+    if (ret < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+#ifdef DEBUG
+      perror("Engine::kickTx sendto error");
+#endif
+      return -1;
+    }
+    return ret;
+  }
+
+  // Obtém o índice da interface e coloca o socket em modo não bloqueante.
+  void confSocket() {
     // Set interfacace index -------------------------------------
     struct ifreq ifr;
     strncpy(ifr.ifr_name, _interface_name, IFNAMSIZ - 1);
@@ -333,11 +1191,9 @@ private:
       exit(EXIT_FAILURE);
     }
 
-    // O_ASYNC faz com que o socket levante o sinal SIGIO quando operacoes de
-    // I/O acontecerem O_NONBLOCK faz com que operações normalmente bloqueantes
-    // não bloqueiem
-    if (fcntl(Engine::getSocketFd(), F_SETFL, flags | O_ASYNC | O_NONBLOCK) <
-        0) {
+    // O_NONBLOCK faz com que operações normalmente bloqueantes não bloqueiem;
+    // a espera por quadros fica a cargo do epoll
+    if (fcntl(Engine::getSocketFd(), F_SETFL, flags | O_NONBLOCK) < 0) {
       perror("fcntl F_SETFL");
       exit(EXIT_FAILURE);
     }
@@ -348,35 +1204,38 @@ private:
   int _interface_index;
   const char *_interface_name;
   Ethernet::Address _address;
+  // Socket e anel de recepção de cada fila (_rx_fds[0] == _socket_raw)
+  int _rx_fds[RX_THREADS];
+  RxRing _rx_rings[RX_THREADS];
+  // Socket e anel de transmissão (apenas com Config::TX_RING)
+  int _socket_tx = -1;
+  TxRing _tx_ring;
+  // Socket com timestamps de transmissão (apenas com Config::TIMESTAMPING)
+  int _socket_stamp = -1;
+  // Sockets de transmissão por thread (apenas com Config::PER_THREAD_TX)
+  inline static std::atomic<uint64_t> _next_instance_id{ 0 };
+  const uint64_t _instance_id = _next_instance_id++;
+  std::vector<int> _thread_tx_fds;
+  std::mutex _thread_tx_mtx;
+  std::mutex _stamp_mtx;
+  // Envios seguidos sem timestamp de transmissão
+  unsigned int _tx_stamp_misses = 0;
+  static constexpr unsigned int MAX_TX_STAMP_MISSES = 3;
 
-  // Função estática para envelopar a função que tratará a interrupção
-  static void signalHandler([[maybe_unused]] int sig) {
-    _self->newMessage = true;
-    _self->engine_cond.notify_one();
-  }
-
-  static void *obj;
-  static void (*handler)(void *);
-
-  static Engine *_self;
+  // Objeto (NIC) e função chamados a cada evento de recepção
+  void *_obj = nullptr;
+  void (*_handler)(void *) = nullptr;
 
   // ---- Controle da thread de recepcao ----
-  bool newMessage;
-  std::thread recvThread;
-  bool _thread_running;
-  std::condition_variable engine_cond;
-  std::mutex engine_lock_mutex;
-  std::unique_lock<std::mutex> engine_lock;
-  pthread_mutex_t _threadStopMutex = PTHREAD_MUTEX_INITIALIZER;
+  std::thread _rx_threads[RX_THREADS];
+  // epoll de cada fila, com o socket da fila e o eventfd que sinaliza o
+  // término das threads
+  int _epoll_fds[RX_THREADS];
+  int _stop_fd = -1;
+  // Fila atendida pela thread de recepção corrente
+  inline static thread_local unsigned int _rx_queue = 0;
+  // Consultado pelas políticas que não dormem no epoll
+  std::atomic<bool> _running{true};
 };
 
-template <typename DataWrapper>
-Engine<DataWrapper> *Engine<DataWrapper>::_self = nullptr;
-
-template <typename DataWrapper>
-void *Engine<DataWrapper>::obj = nullptr;
-
-template <typename DataWrapper>
-void (*Engine<DataWrapper>::handler)(void *) = nullptr;
-
 #endif
@@ -0,0 +1,259 @@
+#ifndef ENGINE_HELPERS_HH
+#define ENGINE_HELPERS_HH
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <initializer_list>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <linux/errqueue.h>
+#include <linux/filter.h>
+#include <linux/net_tstamp.h>
+#include <net/if.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "ethernet.hh"
+
+// Partes comuns às Engines de rede (Engine, IoUringEngine, XdpEngine,
+// UdpMulticastEngine): filtro BPF por SysID, consulta da interface,
+// timestamps do kernel e a thread de recepção guiada por epoll.
+namespace EngineHelpers {
+
+// Monta o programa BPF que descarta no kernel os quadros originados pelo
+// próprio sistema e os destinados a outros sistemas. Os SysIDs são lidos do
+// quadro como inteiros de 32 bits na ordem do host.
+// Args:
+//   base: Posição do início do quadro nos dados vistos pelo filtro (ex.: o
+//   tamanho do cabeçalho UDP em um socket UDP).
+//   ethertype: Ethertype exigido no quadro, ou 0 para não verificá-lo.
+//   origin_offset: Deslocamento do SysID de origem a partir do início do
+//   quadro.
+//   dest_offset: Deslocamento do SysID de destino a partir do início do
+//   quadro.
+//   own: SysID local.
+//   accepted: SysIDs de destino aceitos além do local (ex.: broadcasts).
+// Returns:
+//   Instruções do programa, prontas para attachFilter.
+inline std::vector<struct sock_filter>
+sysIDFilter(unsigned int base, uint16_t ethertype, unsigned int origin_offset,
+            unsigned int dest_offset, int32_t own,
+            std::initializer_list<int32_t> accepted) {
+  // Índices das instruções de descarte e de aceite (fim do programa)
+  const size_t drop = (ethertype != 0 ? 2 : 0) + 4 + accepted.size();
+  const size_t accept = drop + 1;
+
+  std::vector<struct sock_filter> code;
+  // ld [k] carrega a palavra em big-endian
+  auto wire = [](int32_t id) { return htonl(static_cast<uint32_t>(id)); };
+  auto load = [&](uint16_t size, unsigned int offset) {
+    code.push_back(BPF_STMT(BPF_LD | size | BPF_ABS, base + offset));
+  };
+  // Os saltos do BPF são relativos à instrução seguinte; jt e jf são
+  // índices absolutos, com next() para seguir em frente
+  auto next = [&]() { return code.size() + 1; };
+  auto jeq = [&](uint32_t k, size_t jt, size_t jf) {
+    size_t from = code.size() + 1;
+    code.push_back(sock_filter{ BPF_JMP | BPF_JEQ | BPF_K,
+                                static_cast<unsigned char>(jt - from),
+                                static_cast<unsigned char>(jf - from), k });
+  };
+
+  if (ethertype != 0) {
+    load(BPF_H, 12);
+    jeq(ethertype, next(), drop);
+  }
+  // Descarta quadros enviados pelo próprio sistema
+  load(BPF_W, origin_offset);
+  jeq(wire(own), drop, next());
+  // Aceita apenas destinos conhecidos
+  load(BPF_W, dest_offset);
+  jeq(wire(own), accept, next());
+  for (int32_t id : accepted) {
+    jeq(wire(id), accept, next());
+  }
+  code.push_back(BPF_STMT(BPF_RET | BPF_K, 0x00000000)); // Descarta
+  code.push_back(BPF_STMT(BPF_RET | BPF_K, 0x0000ffff)); // Aceita
+  return code;
+}
+
+// Anexa um programa BPF ao socket. Um novo SO_ATTACH_FILTER substitui o
+// filtro anterior atomicamente.
+// Args:
+//   fd: Socket que receberá o filtro.
+//   code: Instruções do programa (ver sysIDFilter).
+inline void attachFilter(int fd, std::vector<struct sock_filter> &code) {
+  struct sock_fprog bpf_prog = {
+    .len = static_cast<unsigned short>(code.size()),
+    .filter = code.data(),
+  };
+  if (setsockopt(fd, SOL_SOCKET, SO_ATTACH_FILTER, &bpf_prog,
+                 sizeof(bpf_prog))) {
+    perror("setsockopt SO_ATTACH_FILTER");
+    exit(EXIT_FAILURE);
+  }
+}
+
+// Obtém o MAC e o índice de uma interface.
+// Args:
+//   name: Nome da interface.
+//   address: Recebe o MAC da interface.
+// Returns:
+//   Índice da interface ou 0 em caso de erro.
+inline unsigned int interfaceInfo(const char *name,
+                                  Ethernet::Address &address) {
+  int fd = socket(AF_INET, SOCK_DGRAM, 0);
+  if (fd < 0) {
+    return 0;
+  }
+  struct ifreq ifr;
+  std::memset(&ifr, 0, sizeof(ifr));
+  strncpy(ifr.ifr_name, name, IFNAMSIZ - 1);
+  if (ioctl(fd, SIOCGIFHWADDR, &ifr) == -1) {
+    close(fd);
+    return 0;
+  }
+  address = Ethernet::Address(
+      reinterpret_cast<const unsigned char *>(ifr.ifr_hwaddr.sa_data));
+  close(fd);
+  return if_nametoindex(name);
+}
+
+// Extrai de uma mensagem recebida o timestamp SCM_TIMESTAMPING.
+// Args:
+//   msg: Mensagem com o espaço de controle preenchido pelo kernel.
+//   hardware: Prefere o timestamp da placa, quando disponível, ao do
+//   software.
+// Returns:
+//   Instante registrado pelo kernel (us, relógio do sistema) ou 0.
+inline int64_t kernelTime(struct msghdr *msg, bool hardware) {
+  for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(msg); cmsg != nullptr;
+       cmsg = CMSG_NXTHDR(msg, cmsg)) {
+    if (cmsg->cmsg_level != SOL_SOCKET ||
+        cmsg->cmsg_type != SCM_TIMESTAMPING) {
+      continue;
+    }
+    struct scm_timestamping stamps;
+    std::memcpy(&stamps, CMSG_DATA(cmsg), sizeof(stamps));
+    // ts[0]: software; ts[2]: hardware
+    const struct timespec *ts = &stamps.ts[0];
+    if (hardware && (stamps.ts[2].tv_sec != 0 || stamps.ts[2].tv_nsec != 0)) {
+      ts = &stamps.ts[2];
+    }
+    return static_cast<int64_t>(ts->tv_sec) * 1000000 + ts->tv_nsec / 1000;
+  }
+  return 0;
+}
+
+// Thread de recepção de uma Engine com uma única fila: espera no epoll pelos
+// fds registrados com watch() e chama o tratador a cada evento, até que
+// stop() a acorde pelo eventfd de parada.
+class RecvThread {
+public:
+  RecvThread() = default;
+  RecvThread(const RecvThread &) = delete;
+  RecvThread &operator=(const RecvThread &) = delete;
+
+  ~RecvThread() {
+    stop();
+    for (int fd : { _epoll_fd, _stop_fd }) {
+      if (fd != -1) {
+        close(fd);
+      }
+    }
+  }
+
+  // Cria o epoll com o eventfd de parada e dispara a thread.
+  // Args:
+  //   on_event: Chamado na thread a cada evento dos fds observados.
+  template <typename F>
+  void start(F on_event) {
+    _epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (_epoll_fd < 0) {
+      perror("epoll_create1");
+      exit(EXIT_FAILURE);
+    }
+    _stop_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (_stop_fd < 0) {
+      perror("eventfd");
+      exit(EXIT_FAILURE);
+    }
+    struct epoll_event ev;
+    std::memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.fd = _stop_fd;
+    if (epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, _stop_fd, &ev) < 0) {
+      perror("epoll_ctl (eventfd)");
+      exit(EXIT_FAILURE);
+    }
+
+    _thread = std::thread([this, on_event]() {
+      struct epoll_event events[2];
+      while (true) {
+        int n = epoll_wait(_epoll_fd, events, 2, -1);
+        if (n < 0) {
+          if (errno == EINTR) {
+            continue;
+          }
+          perror("epoll_wait");
+          break;
+        }
+        bool readable = false;
+        for (int i = 0; i < n; i++) {
+          if (events[i].data.fd == _stop_fd) {
+            return;
+          }
+          readable = true;
+        }
+        if (readable) {
+          on_event();
+        }
+      }
+    });
+  }
+
+  // Registra um fd no epoll em modo edge-triggered: cada chegada gera um
+  // evento e o tratador deve drenar o fd até EAGAIN.
+  // Args:
+  //   fd: Descritor observado.
+  //   what: Nome do descritor nas mensagens de erro.
+  void watch(int fd, const char *what) {
+    struct epoll_event ev;
+    std::memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN | EPOLLET;
+    ev.data.fd = fd;
+    if (epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+      fprintf(stderr, "epoll_ctl (%s): %s\n", what, strerror(errno));
+      exit(EXIT_FAILURE);
+    }
+  }
+
+  // Acorda a thread pelo eventfd e espera que ela termine.
+  void stop() {
+    uint64_t one = 1;
+    if (_stop_fd != -1 && write(_stop_fd, &one, sizeof(one)) < 0) {
+      perror("write eventfd");
+    }
+    if (_thread.joinable()) {
+      _thread.join();
+    }
+  }
+
+private:
+  std::thread _thread;
+  int _epoll_fd = -1;
+  int _stop_fd = -1;
+};
+
+} // namespace EngineHelpers
+
+#endif
@@ -0,0 +1,685 @@
+#ifndef IO_URING_ENGINE_HH
+#define IO_URING_ENGINE_HH
+
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <initializer_list>
+#include <iostream>
+#include <mutex>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <linux/filter.h>
+#include <linux/if_ether.h>
+#include <linux/if_packet.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "buffer.hh"
+#include "engine_helpers.hh"
+#include "ethernet.hh"
+
+// Configuração da IoUringEngine em tempo de compilação. Para trocar a
+// geometria, herde desta estrutura e sobrescreva os campos desejados.
+struct DefaultIoUringConfig {
+  // Quadros da área registrada: a primeira metade abastece a recepção (anel
+  // de buffers fornecidos) e a segunda o envio (buffers fixos)
+  static constexpr unsigned int FRAME_COUNT = 2048;
+  static constexpr unsigned int FRAME_SIZE = 2048;
+  // Entradas da fila de submissão de cada anel (potência de 2)
+  static constexpr unsigned int SQ_SIZE = 64;
+  // Grupo de buffers fornecidos usado pela recepção
+  static constexpr uint16_t BUFFER_GROUP = 0;
+  // Quadros de recepção devolvidos acumulados antes de serem fornecidos de
+  // novo ao kernel (uma chamada de sistema por lote)
+  static constexpr unsigned int REPLENISH_BATCH = 32;
+};
+
+// Anel io_uring (fila de submissão e de conclusão) mapeado a partir do fd
+// devolvido por io_uring_setup. Usado sem liburing, por chamadas de sistema
+// diretas.
+class UringQueue {
+public:
+  // Cria o anel e mapeia as filas.
+  // Args:
+  //   sq_entries: Entradas da fila de submissão.
+  //   cq_entries: Entradas da fila de conclusão.
+  // Returns:
+  //   false em caso de erro (errno preenchido).
+  bool setup(unsigned int sq_entries, unsigned int cq_entries) {
+    struct io_uring_params p;
+    std::memset(&p, 0, sizeof(p));
+    p.flags = IORING_SETUP_CQSIZE;
+    p.cq_entries = cq_entries;
+    _fd = syscall(__NR_io_uring_setup, sq_entries, &p);
+    if (_fd < 0) {
+      return false;
+    }
+
+    _sq_map_size = p.sq_off.array + p.sq_entries * sizeof(uint32_t);
+    _cq_map_size = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+    if (p.features & IORING_FEAT_SINGLE_MMAP) {
+      _sq_map_size = _cq_map_size = std::max(_sq_map_size, _cq_map_size);
+    }
+    _sq_map = mmap(nullptr, _sq_map_size, PROT_READ | PROT_WRITE,
+                   MAP_SHARED | MAP_POPULATE, _fd, IORING_OFF_SQ_RING);
+    if (_sq_map == MAP_FAILED) {
+      _sq_map = nullptr;
+      return false;
+    }
+    if (p.features & IORING_FEAT_SINGLE_MMAP) {
+      _cq_map = _sq_map;
+    } else {
+      _cq_map = mmap(nullptr, _cq_map_size, PROT_READ | PROT_WRITE,
+                     MAP_SHARED | MAP_POPULATE, _fd, IORING_OFF_CQ_RING);
+      if (_cq_map == MAP_FAILED) {
+        _cq_map = nullptr;
+        return false;
+      }
+    }
+    _sqes_size = p.sq_entries * sizeof(io_uring_sqe);
+    void *sqes = mmap(nullptr, _sqes_size, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, _fd, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) {
+      return false;
+    }
+    _sqes = static_cast<io_uring_sqe *>(sqes);
+
+    auto *sq = static_cast<std::byte *>(_sq_map);
+    auto *cq = static_cast<std::byte *>(_cq_map);
+    _sq_head = reinterpret_cast<uint32_t *>(sq + p.sq_off.head);
+    _sq_tail = reinterpret_cast<uint32_t *>(sq + p.sq_off.tail);
+    _sq_mask = *reinterpret_cast<uint32_t *>(sq + p.sq_off.ring_mask);
+    _sq_entries = p.sq_entries;
+    _cq_head = reinterpret_cast<uint32_t *>(cq + p.cq_off.head);
+    _cq_tail = reinterpret_cast<uint32_t *>(cq + p.cq_off.tail);
+    _cq_mask = *reinterpret_cast<uint32_t *>(cq + p.cq_off.ring_mask);
+    _cqes = reinterpret_cast<io_uring_cqe *>(cq + p.cq_off.cqes);
+
+    // Cada entrada do vetor aponta para o SQE de mesmo índice
+    uint32_t *array = reinterpret_cast<uint32_t *>(sq + p.sq_off.array);
+    for (unsigned int i = 0; i < p.sq_entries; i++) {
+      array[i] = i;
+    }
+    _local_tail = *_sq_tail;
+    return true;
+  }
+
+  // Desmapeia as filas e fecha o anel (cancela as operações pendentes).
+  void teardown() {
+    if (_sqes != nullptr) {
+      munmap(_sqes, _sqes_size);
+      _sqes = nullptr;
+    }
+    if (_cq_map != nullptr && _cq_map != _sq_map) {
+      munmap(_cq_map, _cq_map_size);
+    }
+    if (_sq_map != nullptr) {
+      munmap(_sq_map, _sq_map_size);
+    }
+    _sq_map = _cq_map = nullptr;
+    if (_fd != -1) {
+      close(_fd);
+      _fd = -1;
+    }
+  }
+
+  // Retorna o próximo SQE livre, zerado, ou nullptr se a fila estiver
+  // cheia. O SQE só é visto pelo kernel após submit().
+  io_uring_sqe *nextSqe() {
+    uint32_t head = std::atomic_ref<uint32_t>(*_sq_head).load(
+        std::memory_order_acquire);
+    if (_local_tail - head >= _sq_entries) {
+      return nullptr;
+    }
+    io_uring_sqe *sqe = &_sqes[_local_tail & _sq_mask];
+    std::memset(sqe, 0, sizeof(*sqe));
+    _local_tail++;
+    return sqe;
+  }
+
+  // Publica os SQEs preenchidos e os entrega ao kernel.
+  // Returns:
+  //   Quantidade de SQEs consumidos ou -1 em caso de erro.
+  int submit() {
+    uint32_t tail = *_sq_tail;
+    unsigned int pending = _local_tail - tail;
+    std::atomic_ref<uint32_t>(*_sq_tail).store(_local_tail,
+                                               std::memory_order_release);
+    if (pending == 0) {
+      return 0;
+    }
+    int ret;
+    do {
+      ret = syscall(__NR_io_uring_enter, _fd, pending, 0, 0, nullptr, 0);
+    } while (ret < 0 && errno == EINTR);
+    return ret;
+  }
+
+  // Consome uma entrada da fila de conclusão.
+  // Returns:
+  //   false se a fila estiver vazia.
+  bool pop(io_uring_cqe &cqe) {
+    uint32_t head = *_cq_head;
+    if (head == std::atomic_ref<uint32_t>(*_cq_tail).load(
+                       std::memory_order_acquire)) {
+      return false;
+    }
+    cqe = _cqes[head & _cq_mask];
+    std::atomic_ref<uint32_t>(*_cq_head).store(head + 1,
+                                               std::memory_order_release);
+    return true;
+  }
+
+  // Registra recursos no anel (io_uring_register).
+  int registerOp(unsigned int opcode, void *arg, unsigned int nr) {
+    return syscall(__NR_io_uring_register, _fd, opcode, arg, nr);
+  }
+
+  int fd() const {
+    return _fd;
+  }
+
+private:
+  int _fd = -1;
+  void *_sq_map = nullptr;
+  void *_cq_map = nullptr;
+  size_t _sq_map_size = 0;
+  size_t _cq_map_size = 0;
+  size_t _sqes_size = 0;
+  io_uring_sqe *_sqes = nullptr;
+  uint32_t *_sq_head = nullptr;
+  uint32_t *_sq_tail = nullptr;
+  uint32_t _sq_mask = 0;
+  uint32_t _sq_entries = 0;
+  uint32_t _local_tail = 0;
+  uint32_t *_cq_head = nullptr;
+  uint32_t *_cq_tail = nullptr;
+  uint32_t _cq_mask = 0;
+  io_uring_cqe *_cqes = nullptr;
+};
+
+// Engine sobre io_uring, com a mesma interface da Engine de socket raw, para
+// uso em NIC<IoUringEngine<Ethernet>>. Usa o mesmo socket AF_PACKET, mas a
+// E/S passa por dois anéis io_uring, sem o gerenciamento de anéis mmap do
+// AF_PACKET:
+//  - Recepção: um recv multishot fica armado no socket e o kernel escolhe os
+//    quadros entre os buffers fornecidos (IORING_OP_PROVIDE_BUFFERS). A NIC
+//    recebe os quadros associados (attach) aos Buffers do pool, sem cópia, e
+//    ao liberá-los (NIC::free) eles voltam a ser fornecidos, em lotes.
+//  - Envio: os quadros de envio são buffers fixos registrados no anel
+//    (IORING_OP_WRITE_FIXED). NIC::alloc(1) entrega um quadro livre e o
+//    envio é assíncrono: o quadro só volta a ficar livre quando a conclusão
+//    chega e a NIC o libera.
+template <typename DataWrapper, typename Config = DefaultIoUringConfig>
+class IoUringEngine {
+public:
+  using FrameClass = DataWrapper;
+  using Frame = typename FrameClass::Frame;
+
+  // Tamanho da rajada usada pela NIC ao drenar a fila de conclusão
+  static constexpr unsigned int RECEIVE_BURST = 32;
+
+  static constexpr unsigned int RX_FRAMES = Config::FRAME_COUNT / 2;
+  static constexpr unsigned int TX_FRAMES = Config::FRAME_COUNT - RX_FRAMES;
+  static_assert(Config::FRAME_SIZE >= Buffer::BUFFER_SIZE,
+                "Quadro menor que o Buffer");
+
+public:
+  // Construtor: Cria o socket, a área de quadros e os anéis io_uring.
+  IoUringEngine(const char *interface_name) : _interface_name(interface_name) {
+    if (!get_interface_info()) {
+      perror("IoUringEngine Error: interface info");
+      exit(EXIT_FAILURE);
+    }
+
+    setupSocket();
+    setupFrames();
+    setupRings();
+
+    turnRecvOn();
+#ifdef DEBUG
+    std::cout << "IoUringEngine initialized for interface " << _interface_name
+              << std::endl;
+#endif
+  }
+
+  // Destrutor: Para a recepção e desfaz os anéis e a área de quadros.
+  ~IoUringEngine() {
+    stopReceiving();
+
+    // Fechar os anéis cancela o recv multishot e os envios pendentes
+    _rx_ring.teardown();
+    _tx_ring.teardown();
+    if (_socket != -1) {
+      close(_socket);
+    }
+    if (_frames != nullptr) {
+      munmap(_frames, framesSize());
+    }
+  }
+
+  // Submete o envio de um buffer. Buffers associados a quadros de envio
+  // (ver reserve()) são enviados sem cópia; os demais são copiados para um
+  // quadro livre. O envio é assíncrono: o quadro fica com o kernel até a
+  // conclusão.
+  // Args:
+  //   buf: Ponteiro para o Buffer contendo o quadro a ser enviado.
+  // Returns:
+  //   Número de bytes submetidos ou -1 em caso de erro.
+  int send(Buffer *buf) {
+    if (!buf)
+      return -1;
+
+    std::lock_guard<std::mutex> lock(_tx_mtx);
+    reclaim();
+    if (!queue(buf) || _tx_ring.submit() < 1) {
+#ifdef DEBUG
+      perror("IoUringEngine::send error");
+#endif
+      return -1;
+    }
+    return buf->size();
+  }
+
+  // Submete uma rajada de envios com uma única chamada de sistema.
+  // Args:
+  //   bufs: Vetor de buffers a serem enviados.
+  //   n: Quantidade de buffers no vetor.
+  // Returns:
+  //   Quantidade de quadros submetidos (os primeiros do vetor) ou -1 em caso
+  //   de erro.
+  int send_burst(Buffer **bufs, int n) {
+    std::lock_guard<std::mutex> lock(_tx_mtx);
+    reclaim();
+    int queued = 0;
+    while (queued < n && queue(bufs[queued])) {
+      queued++;
+    }
+    if (queued == 0) {
+      return -1;
+    }
+    // SQEs não consumidos pelo kernel seguem na fila para a próxima submissão
+    return _tx_ring.submit() >= 0 ? queued : -1;
+  }
+
+  // Recebe um quadro da fila de conclusão, associando o buffer ao quadro
+  // escolhido pelo kernel.
+  // Args:
+  //   buf: Buffer do pool que será associado ao quadro.
+  // Returns:
+  //   Número de bytes recebidos ou 0 se não houver quadros.
+  int receive(Buffer *buf) {
+    io_uring_cqe cqe;
+    while (_rx_ring.pop(cqe)) {
+      if (!(cqe.flags & IORING_CQE_F_MORE)) {
+        // O recv multishot terminou (ex.: sem buffers fornecidos)
+        std::lock_guard<std::mutex> lock(_fill_mtx);
+        _rx_armed = false;
+        replenish();
+      }
+      if (!(cqe.flags & IORING_CQE_F_BUFFER)) {
+#ifdef DEBUG
+        if (cqe.res < 0 && cqe.res != -ENOBUFS) {
+          errno = -cqe.res;
+          perror("IoUringEngine::receive recv error");
+        }
+#endif
+        continue;
+      }
+      unsigned int frame = cqe.flags >> IORING_CQE_BUFFER_SHIFT;
+      {
+        std::lock_guard<std::mutex> lock(_fill_mtx);
+        _rx_in_kernel--;
+      }
+      buf->attach(frameData(frame), frame);
+      if (cqe.res <= 0) {
+        // Quadro sem dados: volta direto para o anel
+        release(buf);
+        continue;
+      }
+      buf->setSize(cqe.res);
+      return cqe.res;
+    }
+    buf->setSize(0);
+    return 0;
+  }
+
+  // Recebe uma rajada de quadros da fila de conclusão.
+  // Returns:
+  //   Quantidade de quadros recebidos (os primeiros do vetor).
+  int receive_burst(Buffer **bufs, int n) {
+    int received = 0;
+    while (received < n && receive(bufs[received]) > 0) {
+      received++;
+    }
+    return received;
+  }
+
+  // Devolve à Engine um quadro associado a um buffer.
+  // Args:
+  //   buf: Buffer associado por receive() ou reserve().
+  void release(Buffer *buf) {
+    unsigned int frame = buf->ext_ctx();
+    if (frame < RX_FRAMES) {
+      // Quadro de recepção volta a ser fornecido ao kernel
+      std::lock_guard<std::mutex> lock(_fill_mtx);
+      _rx_returned.push_back(frame);
+      if (_rx_returned.size() >= Config::REPLENISH_BATCH || !_rx_armed) {
+        replenish();
+      }
+    } else {
+      std::lock_guard<std::mutex> lock(_tx_mtx);
+      unref(frame);
+    }
+    buf->detach();
+  }
+
+  // Associa um buffer de envio a um quadro livre, para que o quadro seja
+  // montado direto no buffer fixo lido pelo kernel.
+  // Returns:
+  //   false se não houver quadro livre (o buffer usa sua área interna).
+  bool reserve(Buffer *buf) {
+    std::lock_guard<std::mutex> lock(_tx_mtx);
+    reclaim();
+    if (_tx_free.empty()) {
+      return false;
+    }
+    unsigned int frame = _tx_free.back();
+    _tx_free.pop_back();
+    _tx_refs[frame - RX_FRAMES] = 1; // Referência do buffer
+    buf->attach(frameData(frame), frame);
+    return true;
+  }
+
+  // Substitui o filtro BPF do socket por um que descarta no kernel os
+  // quadros originados pelo próprio sistema e os destinados a outros
+  // sistemas. Mesma semântica de Engine::filterSysID.
+  void filterSysID(unsigned int origin_offset, unsigned int dest_offset,
+                   int32_t own, std::initializer_list<int32_t> accepted) {
+    std::vector<struct sock_filter> bpf_code = EngineHelpers::sysIDFilter(
+        0, 0x88b5, origin_offset, dest_offset, own, accepted);
+    EngineHelpers::attachFilter(_socket, bpf_code);
+  }
+
+  const Ethernet::Address &getAddress() {
+    return _address;
+  }
+
+  // Quadros descartados pelo kernel desde a última chamada. Mesma semântica
+  // de Engine::kernelDrops.
+  unsigned long long kernelDrops() {
+    struct tpacket_stats stats = {};
+    socklen_t len = sizeof(stats);
+    if (getsockopt(_socket, SOL_PACKET, PACKET_STATISTICS, &stats, &len) < 0) {
+      return 0;
+    }
+    return stats.tp_drops;
+  }
+
+  // Encerra a thread de recepção. Usado por quem precisa parar a entrega
+  // de quadros antes de destruir o próprio estado (ex.: pools da NIC).
+  void stopReceiving() {
+    _recv.stop();
+  }
+
+  template <typename T, void (T::*handle_signal)()>
+  void bind(T *obj) {
+    _obj = obj;
+    _handler = &handlerWrapper<T, handle_signal>;
+    // O fd do anel fica legível quando há entradas na fila de conclusão
+    _recv.watch(_rx_ring.fd(), "io_uring");
+  }
+
+private:
+  // Obtém MAC e índice da interface.
+  bool get_interface_info() {
+    _interface_index =
+        EngineHelpers::interfaceInfo(_interface_name, _address);
+    return _interface_index != 0;
+  }
+
+  // Cria o socket raw ligado à interface. Com o bind, o write do quadro
+  // inteiro dispensa o endereço de destino.
+  void setupSocket() {
+    _socket = socket(AF_PACKET, SOCK_RAW | SOCK_CLOEXEC, htons(ETH_P_ALL));
+    if (_socket == -1) {
+      perror("socket creation (raw)");
+      exit(EXIT_FAILURE);
+    }
+
+    int tam = 8 * 1024 * 1024;
+    if (setsockopt(_socket, SOL_SOCKET, SO_RCVBUFFORCE, &tam, sizeof(tam)) <
+        0) {
+      perror("setsockopt SO_RCVBUF");
+    }
+
+    struct sockaddr_ll sll;
+    std::memset(&sll, 0, sizeof(sll));
+    sll.sll_family = AF_PACKET;
+    sll.sll_protocol = htons(ETH_P_ALL);
+    sll.sll_ifindex = _interface_index;
+    if (::bind(_socket, (struct sockaddr *)&sll, sizeof(sll)) < 0) {
+      perror("bind (raw socket)");
+      exit(EXIT_FAILURE);
+    }
+  }
+
+  // Aloca a área de quadros compartilhada pelos dois anéis.
+  void setupFrames() {
+    void *frames = mmap(nullptr, framesSize(), PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
+    if (frames == MAP_FAILED) {
+      perror("mmap (io_uring frames)");
+      exit(EXIT_FAILURE);
+    }
+    _frames = static_cast<std::byte *>(frames);
+
+    _rx_returned.reserve(RX_FRAMES);
+    _tx_refs.assign(TX_FRAMES, 0);
+    for (unsigned int i = Config::FRAME_COUNT; i > RX_FRAMES; i--) {
+      _tx_free.push_back(i - 1);
+    }
+  }
+
+  // Cria os anéis de recepção e de envio, registra os buffers fixos,
+  // fornece os quadros de recepção e arma o recv multishot.
+  void setupRings() {
+    // A fila de conclusão comporta todos os quadros em trânsito
+    if (!_rx_ring.setup(Config::SQ_SIZE, 2 * RX_FRAMES) ||
+        !_tx_ring.setup(Config::SQ_SIZE, 2 * TX_FRAMES)) {
+      perror("io_uring_setup");
+      exit(EXIT_FAILURE);
+    }
+
+    // Buffers fixos: a área de envio fica mapeada no kernel, sem
+    // get_user_pages a cada envio
+    struct iovec iov;
+    iov.iov_base = frameData(RX_FRAMES);
+    iov.iov_len = static_cast<size_t>(TX_FRAMES) * Config::FRAME_SIZE;
+    _fixed = _tx_ring.registerOp(IORING_REGISTER_BUFFERS, &iov, 1) == 0;
+    if (!_fixed) {
+      perror("io_uring_register IORING_REGISTER_BUFFERS");
+    }
+
+    // Os quadros de recepção são contíguos: um único SQE fornece todos
+    std::lock_guard<std::mutex> lock(_fill_mtx);
+    io_uring_sqe *sqe = _rx_ring.nextSqe();
+    provide(sqe, 0, RX_FRAMES);
+    _rx_in_kernel = RX_FRAMES;
+    replenish();
+  }
+
+  // Prepara um SQE que fornece ao kernel quadros de recepção consecutivos.
+  // Args:
+  //   sqe: SQE livre da fila de recepção.
+  //   frame: Primeiro quadro (também é o ID do buffer).
+  //   count: Quantidade de quadros.
+  void provide(io_uring_sqe *sqe, unsigned int frame, unsigned int count) {
+    sqe->opcode = IORING_OP_PROVIDE_BUFFERS;
+    sqe->fd = count;
+    sqe->addr = reinterpret_cast<uint64_t>(frameData(frame));
+    sqe->len = Config::FRAME_SIZE;
+    sqe->off = frame;
+    sqe->buf_group = Config::BUFFER_GROUP;
+    // Só falhas geram conclusão
+    sqe->flags = IOSQE_CQE_SKIP_SUCCESS;
+  }
+
+  // Fornece de novo ao kernel os quadros devolvidos e, se o recv multishot
+  // não estiver ativo e houver quadros fornecidos, o arma. Tudo segue em
+  // uma única submissão.
+  // Deve ser chamado com _fill_mtx travado.
+  void replenish() {
+    while (!_rx_returned.empty()) {
+      io_uring_sqe *sqe = _rx_ring.nextSqe();
+      if (sqe == nullptr) {
+        break;
+      }
+      provide(sqe, _rx_returned.back(), 1);
+      _rx_returned.pop_back();
+      _rx_in_kernel++;
+    }
+    bool arming = false;
+    if (!_rx_armed && _rx_in_kernel > 0) {
+      io_uring_sqe *sqe = _rx_ring.nextSqe();
+      if (sqe != nullptr) {
+        sqe->opcode = IORING_OP_RECV;
+        sqe->fd = _socket;
+        sqe->flags = IOSQE_BUFFER_SELECT;
+        sqe->buf_group = Config::BUFFER_GROUP;
+        sqe->ioprio = IORING_RECV_MULTISHOT;
+        arming = true;
+      }
+    }
+    if (_rx_ring.submit() < 0) {
+      perror("IoUringEngine: io_uring_enter (recv)");
+      return;
+    }
+    if (arming) {
+      _rx_armed = true;
+    }
+  }
+
+  // Dispara a thread de recepção, que chama o handler da NIC a cada evento
+  // do anel.
+  void turnRecvOn() {
+    _recv.start([this]() { _handler(_obj); });
+  }
+
+  template <typename T, void (T::*handle_signal)()>
+  static void handlerWrapper(void *obj) {
+    T *typedObj = static_cast<T *>(obj);
+    (typedObj->*handle_signal)();
+  }
+
+  // Prepara o SQE de envio de um buffer, sem submetê-lo.
+  // Deve ser chamado com _tx_mtx travado.
+  // Returns:
+  //   false se não houver quadro ou SQE livre.
+  bool queue(Buffer *buf) {
+    unsigned int frame;
+    if (isTxFrame(buf)) {
+      frame = buf->ext_ctx();
+      _tx_refs[frame - RX_FRAMES]++; // Referência do kernel
+    } else {
+      if (_tx_free.empty()) {
+        return false;
+      }
+      frame = _tx_free.back();
+      _tx_free.pop_back();
+      _tx_refs[frame - RX_FRAMES] = 1;
+      std::memcpy(frameData(frame), buf->template data<std::byte>(),
+                  buf->size());
+    }
+
+    io_uring_sqe *sqe = _tx_ring.nextSqe();
+    if (sqe == nullptr) {
+      unref(frame);
+      return false;
+    }
+    sqe->opcode = _fixed ? IORING_OP_WRITE_FIXED : IORING_OP_SEND;
+    sqe->fd = _socket;
+    sqe->addr = reinterpret_cast<uint64_t>(frameData(frame));
+    sqe->len = buf->size();
+    sqe->buf_index = 0;
+    sqe->user_data = frame;
+    return true;
+  }
+
+  // Consome as conclusões de envio, soltando a referência do kernel.
+  // Deve ser chamado com _tx_mtx travado.
+  void reclaim() {
+    io_uring_cqe cqe;
+    while (_tx_ring.pop(cqe)) {
+#ifdef DEBUG
+      if (cqe.res < 0) {
+        errno = -cqe.res;
+        perror("IoUringEngine: send completion error");
+      }
+#endif
+      unref(cqe.user_data);
+    }
+  }
+
+  // Solta uma referência (buffer ou kernel) de um quadro de envio.
+  // Deve ser chamado com _tx_mtx travado.
+  void unref(unsigned int frame) {
+    if (--_tx_refs[frame - RX_FRAMES] == 0) {
+      _tx_free.push_back(frame);
+    }
+  }
+
+  bool isTxFrame(Buffer *buf) {
+    return buf->is_attached() && buf->ext_ctx() >= (int)RX_FRAMES &&
+           buf->template data<std::byte>() == frameData(buf->ext_ctx());
+  }
+
+  std::byte *frameData(unsigned int frame) {
+    return _frames + static_cast<size_t>(frame) * Config::FRAME_SIZE;
+  }
+
+  static size_t framesSize() {
+    return static_cast<size_t>(Config::FRAME_COUNT) * Config::FRAME_SIZE;
+  }
+
+  const char *_interface_name;
+  unsigned int _interface_index = 0;
+  Ethernet::Address _address;
+
+  int _socket = -1;
+  std::byte *_frames = nullptr;
+
+  // Recepção: anel io_uring, quadros devolvidos pela NIC e estado do recv
+  // multishot. Os quadros são devolvidos por quem libera buffers (qualquer
+  // thread).
+  UringQueue _rx_ring;
+  std::mutex _fill_mtx;
+  std::vector<unsigned int> _rx_returned;
+  unsigned int _rx_in_kernel = 0;
+  bool _rx_armed = false;
+
+  // Envio: anel io_uring, quadros livres e referências (buffer e kernel)
+  UringQueue _tx_ring;
+  bool _fixed = false;
+  std::mutex _tx_mtx;
+  std::vector<unsigned int> _tx_free;
+  std::vector<int> _tx_refs;
+
+  // Objeto (NIC) e função chamados a cada evento de recepção
+  void *_obj = nullptr;
+  void (*_handler)(void *) = nullptr;
+
+  // ---- Controle da thread de recepcao ----
+  EngineHelpers::RecvThread _recv;
+};
+
+#endif
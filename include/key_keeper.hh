@@ -4,6 +4,8 @@
 #include "mac.hh"
 #include "mac_structs.hh"
 #include <map>
+#include <mutex>
+#include <shared_mutex>
 #include <vector>
 
 class KeyKeeper {
@@ -11,7 +13,10 @@ public:
   KeyKeeper() = default;
   ~KeyKeeper() = default;
 
+  // Pode ser chamado pelas threads de recepção enquanto outras threads
+  // consultam as chaves
   void setKeys(const std::vector<MacKeyEntry> &entries) {
+    std::unique_lock<std::shared_mutex> lock(_mtx);
     keys.clear();
     for (const MacKeyEntry &entry : entries) {
       keys[entry.id] = entry.key;
@@ -19,6 +24,7 @@ public:
   }
 
   MAC::Key getKey(int rsu_id) {
+    std::shared_lock<std::shared_mutex> lock(_mtx);
     auto it = keys.find(rsu_id);
     if (it != keys.end()) {
       return it->second;
@@ -29,6 +35,7 @@ public:
 
 private:
   std::map<int, MAC::Key> keys;
+  std::shared_mutex _mtx;
 };
 
 #endif
@@ -0,0 +1,123 @@
+#ifndef MPMC_QUEUE_HH
+#define MPMC_QUEUE_HH
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// Fila limitada sem travas com vários produtores e vários consumidores.
+//
+// Cada posição do vetor guarda um número de sequência que indica se ela
+// está livre para a volta atual dos produtores ou pronta para os
+// consumidores (fila de Vyukov). Os produtores disputam o índice de escrita
+// e os consumidores o de leitura, cada um com uma troca atômica por
+// elemento. Assim push() e pop() podem ser chamados por qualquer thread: o
+// Concurrent_Observer admite várias threads em updated() e produtores que
+// retiram o mais antigo de uma fila cheia, enquanto a NIC e a SharedEngine
+// usam um único consumidor.
+template <typename T>
+class MpmcQueue {
+public:
+  // Args:
+  //   capacity: Quantidade mínima de elementos; arredondada para uma
+  //   potência de 2.
+  explicit MpmcQueue(size_t capacity)
+      : _mask(round_up(capacity) - 1), _slots(new Slot[_mask + 1]) {
+    for (size_t i = 0; i <= _mask; i++) {
+      _slots[i].seq.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  MpmcQueue(const MpmcQueue &) = delete;
+  MpmcQueue &operator=(const MpmcQueue &) = delete;
+
+  // Insere um elemento. Pode ser chamado por qualquer thread.
+  // Returns:
+  //   false se a fila estiver cheia.
+  bool push(const T &value) {
+    size_t pos = _tail.load(std::memory_order_relaxed);
+    Slot *slot;
+    for (;;) {
+      slot = &_slots[pos & _mask];
+      size_t seq = slot->seq.load(std::memory_order_acquire);
+      intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+      if (diff == 0) {
+        if (_tail.compare_exchange_weak(pos, pos + 1,
+                                        std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        pos = _tail.load(std::memory_order_relaxed);
+      }
+    }
+    slot->value = value;
+    slot->seq.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Retira o elemento mais antigo. Pode ser chamado por qualquer thread;
+  // cada elemento é entregue a uma única chamada.
+  // Returns:
+  //   false se a fila estiver vazia.
+  bool pop(T &value) {
+    size_t pos = _head.load(std::memory_order_relaxed);
+    Slot *slot;
+    for (;;) {
+      slot = &_slots[pos & _mask];
+      size_t seq = slot->seq.load(std::memory_order_acquire);
+      intptr_t diff =
+          static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+      if (diff == 0) {
+        if (_head.compare_exchange_weak(pos, pos + 1,
+                                        std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        pos = _head.load(std::memory_order_relaxed);
+      }
+    }
+    value = slot->value;
+    // Libera a posição para a próxima volta dos produtores
+    slot->seq.store(pos + _mask + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Verifica se há elemento pronto. É só um retrato: outro consumidor pode
+  // retirá-lo antes do próximo pop().
+  bool empty() const {
+    size_t pos = _head.load(std::memory_order_relaxed);
+    return _slots[pos & _mask].seq.load(std::memory_order_acquire) != pos + 1;
+  }
+
+  size_t capacity() const {
+    return _mask + 1;
+  }
+
+private:
+  struct Slot {
+    std::atomic<size_t> seq;
+    T value;
+  };
+
+  static size_t round_up(size_t capacity) {
+    size_t size = 1;
+    while (size < capacity) {
+      size <<= 1;
+    }
+    return size;
+  }
+
+  const size_t _mask;
+  std::unique_ptr<Slot[]> _slots;
+  // Índices de escrita (produtores) e de leitura (consumidores) em linhas de
+  // cache distintas
+  alignas(64) std::atomic<size_t> _tail{ 0 };
+  alignas(64) std::atomic<size_t> _head{ 0 };
+};
+
+#endif
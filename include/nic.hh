@@ -1,12 +1,23 @@
 #ifndef NIC_HH
 #define NIC_HH
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <initializer_list>
+#include <memory>
 #include <mutex>
+#include <thread>
+#include <vector>
 
 #include "buffer.hh"
+#include "buffer_pool.hh"
 #include "conditional_data_observer.hh"
 #include "conditionally_data_observed.hh"
 #include "ethernet.hh"
+#include "mpmc_queue.hh"
+#include "statistics.hh"
 #include "sync_engine.hh"
 
 #ifdef DEBUG
@@ -19,11 +30,29 @@
 #include "debug_timestamp.hh"
 #endif
 
-template <Buffer::BufferType T, size_t... I>
-static constexpr std::array<Buffer, sizeof...(I)>
-make_pool(std::index_sequence<I...>) {
-  return { (static_cast<void>(I), Buffer{T})... };
-}
+// Contrapressão na transmissão. Quando os buffers de envio em uso chegam a
+// high, o tráfego de massa (TxClass::Bulk) é contido até que voltem a low;
+// o tráfego prioritário continua usando os buffers restantes.
+struct TxBackpressure {
+  enum Policy {
+    // Recusa o envio de massa (alloc retorna nullptr)
+    Drop,
+    // Bloqueia o remetente até a folga ou até timeout
+    Block
+  };
+  unsigned int high;
+  unsigned int low;
+  Policy policy;
+  std::chrono::microseconds timeout;
+};
+
+// Classe de tráfego de um envio, usada pela contrapressão
+enum class TxClass {
+  // Sempre recebe buffer enquanto houver (ex.: PUBLISH, PTP)
+  Priority,
+  // Contido acima da marca alta (ex.: mensagens COMMON)
+  Bulk
+};
 
 // A classe NIC (Network Interface Controller).
 // Ela age como a interface de rede, usando a Engine fornecida para E/S,
@@ -40,7 +69,7 @@ class NIC
       private Engine {
 public:
 
-  typedef typename Engine::FrameClass::Statistics Statistics;
+  typedef NICStatistics Statistics;
   typedef typename Engine::FrameClass NICFrameClass;
   typedef typename Engine::FrameClass::Header Header;
   typedef typename Engine::FrameClass::Address Address;
@@ -48,8 +77,13 @@ public:
   typedef Conditional_Data_Observer<Buffer, Protocol_Number> Observer;
   typedef Conditionally_Data_Observed<Buffer, Protocol_Number> Observed;
 
+  // Tamanhos padrão dos pools de envio e recepção
   static constexpr unsigned int SEND_BUFFERS    = 1024;
   static constexpr unsigned int RECEIVE_BUFFERS = 1024;
+  // Espera máxima padrão de um envio de massa contido
+  static constexpr std::chrono::microseconds TX_BLOCK_TIMEOUT{ 10000 };
+  // Quadros por rajada enviada pela thread de transmissão
+  static constexpr unsigned int TX_BURST = 32;
 
   // Determina em tempo de compilação qual BufferType usar
   static constexpr Buffer::BufferType pool_type =
@@ -57,64 +91,124 @@ public:
       ? Buffer::EthernetFrame
       : Buffer::SharedMemFrame;
 
-  // Pools pré‑inicializados em compile-time, mas mutáveis em runtime
-  inline static std::array<Buffer, SEND_BUFFERS> _send_buffer_pool =
-    make_pool<pool_type>(std::make_index_sequence<SEND_BUFFERS>{});
-  inline static std::array<Buffer, RECEIVE_BUFFERS> _recv_buffer_pool =
-    make_pool<pool_type>(std::make_index_sequence<RECEIVE_BUFFERS>{});
-
   // Args:
   //   interface_name: Nome da interface de rede (ex: "eth0").
-  NIC(const char *interface_name, SimulatedClock *clock)
-      : Engine(interface_name), last_used_send_buffer(SEND_BUFFERS - 1),
-        last_used_recv_buffer(RECEIVE_BUFFERS - 1), _clock(clock) {
+  //   send_buffers: Quantidade de buffers do pool de envio.
+  //   recv_buffers: Quantidade de buffers do pool de recepção.
+  NIC(const char *interface_name, SimulatedClock *clock,
+      unsigned int send_buffers = SEND_BUFFERS,
+      unsigned int recv_buffers = RECEIVE_BUFFERS)
+      : Engine(interface_name),
+        _send_buffer_pool(BufferPool::create(send_buffers, pool_type)),
+        _small_send_pool(BufferPool::create(send_buffers, pool_type,
+                                            Buffer::SMALL_BUFFER_SIZE)),
+        _recv_buffer_pool(BufferPool::create(recv_buffers, pool_type)),
+        _backpressure{ send_buffers * 3 / 4, send_buffers / 2,
+                       TxBackpressure::Block, TX_BLOCK_TIMEOUT },
+        // Cabem todos os buffers de envio (pequenos e cheios)
+        _tx_queue(2 * send_buffers), _clock(clock) {
     // Setup Handler -----------------------------------------------------
     Engine::template bind<NIC<Engine>, &NIC<Engine>::handle_signal>(this);
   }
 
-  // Destrutor
+  // Destrutor: para a recepção antes que os pools sejam destruídos
   ~NIC() {
+    stopAsyncTx();
+    if constexpr (requires(Engine &e) { e.stopReceiving(); }) {
+      Engine::stopReceiving();
+    }
   }
 
   // Proibe cópia e atribuição para evitar problemas com ponteiros e estado.
   NIC(const NIC &) = delete;
   NIC &operator=(const NIC &) = delete;
 
-  // Aloca um buffer do pool interno para envio ou recepção.
+  // Aloca um buffer do pool interno para envio ou recepção, em O(1) e sem
+  // travas (ver BufferPool). Quadros de envio de até SMALL_BUFFER_SIZE
+  // bytes vêm da classe de buffers pequenos; esgotada, usa a classe cheia.
+  // Args:
+  //   send: Se o buffer é para envio (a recepção sempre usa buffers cheios).
+  //   size: Tamanho do quadro que será montado no buffer (em bytes).
+  //   cls: Classe do envio; Bulk está sujeita à contrapressão.
   // Retorna: Ponteiro para um Buffer livre, ou nullptr se o pool estiver
-  // esgotado. NOTA: O chamador NÃO deve deletar o buffer, deve usar free()!
-  Buffer *alloc(int send) {
-    std::lock_guard<std::mutex> lock(alloc_mtx);
-
-    unsigned int last_used_buffer =
-        send ? last_used_send_buffer : last_used_recv_buffer;
-    unsigned int buffer_size_l = send ? SEND_BUFFERS : RECEIVE_BUFFERS;
-    auto& buffer_pool = send ? _send_buffer_pool : _recv_buffer_pool;
-
-    for (unsigned int j = 0; j < buffer_size_l; ++j) {
-      int i = (last_used_buffer + j) % buffer_size_l;
-      if (!buffer_pool[i].is_in_use()) {
-        last_used_buffer = i;
-        buffer_pool[i].mark_in_use();
-        return &buffer_pool[i]; // Retorna ponteiro para o buffer encontrado
-      }
+  // esgotado ou a contrapressão recusar o envio. NOTA: O chamador NÃO deve
+  // deletar o buffer, deve usar free()!
+  Buffer *alloc(int send, unsigned int size = Buffer::BUFFER_SIZE,
+                TxClass cls = TxClass::Priority) {
+    if (send && cls == TxClass::Bulk && !admitBulk()) {
+      _statistics.add(Statistics::DROP_BACKPRESSURE);
+      return nullptr;
+    }
+    Buffer *buf = nullptr;
+    if (send && size <= Buffer::SMALL_BUFFER_SIZE) {
+      buf = _small_send_pool->alloc();
     }
-// Se nenhum buffer livre foi encontrado
+    if (buf == nullptr) {
+      buf = send ? _send_buffer_pool->alloc() : _recv_buffer_pool->alloc();
+    }
+    if (buf == nullptr) {
 #ifdef DEBUG
-    std::cerr << "NIC::alloc: Buffer pool exhausted!" << std::endl;
+      std::cerr << "NIC::alloc: Buffer pool exhausted!" << std::endl;
 #endif
-    return nullptr;
+      _statistics.add(Statistics::DROP_POOL_EXHAUSTED);
+      return nullptr;
+    }
+    if (send) {
+      _tx_in_use++;
+    }
+    if constexpr (requires(Engine &e, Buffer *b) { e.reserve(b); }) {
+      // Se a Engine tiver anel de transmissão, o quadro é montado
+      // direto no slot do anel
+      if (send) {
+        Engine::reserve(buf);
+      }
+    }
+    return buf;
   }
 
-  // Libera um buffer de volta para o pool.
+  // Libera uma referência ao buffer; a última o devolve ao pool de origem.
   // Args:
   //   buf: Ponteiro para o buffer a ser liberado (deve ter sido obtido via
   //   alloc()).
   void free(Buffer *buf) {
-    if (!buf)
+    if (!buf || !buf->unref())
+      return;
+    bool released = false;
+    if constexpr (requires(Engine &e, Buffer *b) { e.release(b); }) {
+      if (buf->is_attached()) {
+        // Quadro pertence à Engine (ex.: anel mmap): devolve sem limpar
+        Engine::release(buf);
+        released = true;
+      }
+    }
+    if (!released) {
+      // Só os bytes usados; o resto do buffer já está zerado
+      buf->clear();
+    }
+    // Marca como livre e reseta o tamanho
+    if (_small_send_pool->owns(buf)) {
+      _small_send_pool->free(buf);
+    } else if (_send_buffer_pool->owns(buf)) {
+      _send_buffer_pool->free(buf);
+    } else {
+      _recv_buffer_pool->free(buf);
       return;
-    buf->template data<typename NICFrameClass::Frame>()->clear();
-    buf->mark_free(); // Marca como livre e reseta o tamanho
+    }
+    // Buffer de envio: encerra a contenção ao voltar à marca baixa
+    if (--_tx_in_use <= _backpressure.low && _tx_congested) {
+      std::lock_guard<std::mutex> lock(_tx_mtx);
+      _tx_congested = false;
+      _tx_cv.notify_all();
+    }
+  }
+
+  // Configura a contrapressão na transmissão. Por padrão, o tráfego de
+  // massa é contido com 3/4 dos buffers de envio em uso, bloqueando o
+  // remetente por até TX_BLOCK_TIMEOUT, e liberado com a metade. Deve ser
+  // chamado antes dos envios começarem.
+  void setTxBackpressure(const TxBackpressure &backpressure) {
+    std::lock_guard<std::mutex> lock(_tx_mtx);
+    _backpressure = backpressure;
   }
 
   // --- Funções da API Principal  ---
@@ -129,8 +223,7 @@ public:
     int bytes_sent = Engine::send(buf);
 
     if (bytes_sent > 0) {
-      _statistics.tx_packets++;
-      _statistics.tx_bytes += bytes_sent;
+      _statistics.addFrame(Statistics::TX_PACKETS, bytes_sent);
 #ifdef DEBUG
       std::cout << "NIC::send(buf): Sent " << bytes_sent << " bytes."
                 << std::endl;
@@ -141,20 +234,170 @@ public:
     return bytes_sent;
   }
 
+  // Envia um frame JÁ ALOCADO E PREENCHIDO, passando a posse do buffer à
+  // NIC. Com a transmissão assíncrona ligada (startAsyncTx), o quadro é
+  // enfileirado para a thread de transmissão e o remetente não espera pela
+  // chamada de sistema; senão, é enviado na hora. Em ambos os casos a NIC
+  // libera o buffer.
+  // Args:
+  //   buf: Ponteiro para o buffer contendo o frame a ser enviado.
+  // Returns:
+  //   Número de bytes enfileirados ou enviados, ou -1 em caso de erro.
+  int sendAsync(Buffer *buf) {
+    if (_tx_running.load(std::memory_order_relaxed)) {
+      int size = buf->size();
+      if (_tx_queue.push(buf)) {
+        wakeTx();
+        return size;
+      }
+    }
+    int bytes_sent = send(buf);
+    free(buf);
+    return bytes_sent;
+  }
+
+  // Liga a transmissão assíncrona: uma thread passa a drenar a fila de
+  // sendAsync() em rajadas de até TX_BURST quadros (send_burst).
+  void startAsyncTx() {
+    if (!_tx_running.exchange(true)) {
+      _tx_thread = std::thread(&NIC::txLoop, this);
+    }
+  }
+
+  // Desliga a transmissão assíncrona, enviando os quadros ainda na fila.
+  // Não deve haver chamadas de sendAsync() em andamento.
+  void stopAsyncTx() {
+    if (_tx_running.exchange(false)) {
+      _tx_signal.fetch_add(1);
+      _tx_signal.notify_one();
+      _tx_thread.join();
+    }
+  }
+
+  bool asyncTx() const {
+    return _tx_running.load(std::memory_order_relaxed);
+  }
+
+  // Envia um frame como send(buf) e informa o instante de transmissão,
+  // convertido para o relógio da NIC. Usa o timestamp de transmissão do
+  // kernel quando a Engine o fornece; senão, o relógio logo após o envio.
+  // Args:
+  //   buf: Ponteiro para o buffer contendo o frame a ser enviado.
+  //   tx_time: Recebe o instante de transmissão.
+  // Returns:
+  //   Número de bytes enviados pela Engine ou -1 em caso de erro.
+  int sendTimestamped(Buffer *buf, int64_t &tx_time) {
+    int64_t kernel_time = 0;
+    int bytes_sent;
+    if constexpr (requires(Engine &e, Buffer *b, int64_t &t) {
+                    e.send_timestamped(b, t);
+                  }) {
+      bytes_sent = Engine::send_timestamped(buf, kernel_time);
+    } else {
+      bytes_sent = Engine::send(buf);
+    }
+    tx_time = kernel_time ? _clock->getTimestamp(kernel_time)
+                          : _clock->getTimestamp();
+
+    if (bytes_sent > 0) {
+      _statistics.addFrame(Statistics::TX_PACKETS, bytes_sent);
+    }
+    return bytes_sent;
+  }
+
+  // Envia uma rajada de frames JÁ ALOCADOS E PREENCHIDOS, com uma única
+  // chamada de sistema quando a Engine suporta envio em rajada.
+  // Args:
+  //   bufs: Vetor de ponteiros para os buffers a serem enviados.
+  //   n: Quantidade de buffers no vetor.
+  // Returns:
+  //   Quantidade de frames enviados (os primeiros do vetor) ou -1 em caso de
+  //   erro.
+  int send_burst(Buffer **bufs, int n) {
+    int sent = 0;
+    if constexpr (requires(Engine &e, Buffer **b) { e.send_burst(b, 1); }) {
+      sent = Engine::send_burst(bufs, n);
+    } else {
+      while (sent < n && Engine::send(bufs[sent]) > 0) {
+        sent++;
+      }
+    }
+
+    for (int i = 0; i < sent; i++) {
+      _statistics.addFrame(Statistics::TX_PACKETS, bufs[i]->size());
+    }
+#ifdef DEBUG
+    std::cout << "NIC::send_burst: Sent " << sent << " of " << n
+              << " frames." << std::endl;
+#endif
+    return sent > 0 ? sent : -1;
+  }
+
   // --- Métodos de Gerenciamento e Informação ---
 
+  // Repassa à Engine o filtro de SysIDs no kernel, quando ela oferecer um.
+  // Args: ver Engine::filterSysID.
+  // Returns:
+  //   true se o filtro foi instalado.
+  bool filterSysID(unsigned int origin_offset, unsigned int dest_offset,
+                   int32_t own, std::initializer_list<int32_t> accepted) {
+    if constexpr (requires(Engine &e) { e.filterSysID(0u, 0u, 0, {}); }) {
+      Engine::filterSysID(origin_offset, dest_offset, own, accepted);
+      return true;
+    }
+    return false;
+  }
+
+  // Repassa à Engine o quadrante atual e os quadrantes escutados, quando ela
+  // separar o tráfego por quadrante (ex.: UdpMulticastEngine).
+  // Returns:
+  //   true se a Engine trata quadrantes.
+  bool setQuadrant(int quadrant, const std::vector<int> &listened) {
+    if constexpr (requires(Engine &e) { e.setQuadrant(0, listened); }) {
+      Engine::setQuadrant(quadrant, listened);
+      return true;
+    }
+    return false;
+  }
+
   // Retorna o endereço MAC desta NIC.
   Address address() {
     return Engine::getAddress();
   }
 
-  // Retorna as estatísticas de rede acumuladas.
-  const Statistics &statistics() const {
-    return _statistics;
+  // Retorna as estatísticas de rede acumuladas, incluindo os quadros
+  // descartados pelo kernel quando a Engine os informa.
+  Statistics::Snapshot statistics() {
+    if constexpr (requires(Engine &e) { e.kernelDrops(); }) {
+      _statistics.add(Statistics::DROP_KERNEL, Engine::kernelDrops());
+    }
+    return _statistics.snapshot();
+  }
+
+  // Registra um quadro descartado acima da NIC (ex.: pelo protocolo).
+  // Args:
+  //   reason: Motivo do descarte (Statistics::DROP_*).
+  void countDrop(Statistics::Counter reason) {
+    _statistics.add(reason);
+  }
+
+  // Registra um quadro entregue pelo protocolo dentro do próprio processo,
+  // sem passar pela Engine: conta como enviado e como recebido.
+  // Args:
+  //   bytes: Tamanho do quadro.
+  void countLoopback(unsigned int bytes) {
+    _statistics.addFrame(Statistics::TX_PACKETS, bytes);
+    _statistics.addFrame(Statistics::RX_PACKETS, bytes);
   }
 
   // Método membro que processa o sinal (chamado pelo handler estático)
   void handle_signal() {
+    if constexpr (requires { Engine::RECEIVE_BURST; }) {
+      if constexpr (Engine::RECEIVE_BURST > 1) {
+        handle_burst();
+        return;
+      }
+    }
     int bytes_received = 0;
     do {
       Buffer *buf = nullptr;
@@ -182,23 +425,7 @@ public:
       }
 #endif
       if (bytes_received > 0) {
-        buf->set_receive_time(_clock->getTimestamp());
-        // Pacote recebido!
-        _statistics.rx_packets++;
-        _statistics.rx_bytes += bytes_received;
-        bool notified = this->notify(
-            buf->template data<typename NICFrameClass::Frame>()->prot, buf);
-#ifdef DEBUG
-        std::cout << "NIC::handle_signal: "
-                  << (notified ? "Protocol Notificado"
-                               : "Protocol Não notificado")
-                  << std::endl;
-#endif
-        // Se NENHUM observador (Protocolo) estava interessado (registrado
-        // para este EtherType), a NIC deve liberar o buffer que alocou.
-        if (!notified)
-          free(buf);
-
+        deliver(buf, bytes_received);
       } else if (bytes_received == 0) {
         // Não há mais pacotes disponíveis no momento (recvfrom retornaria 0
         // ou -1 com EAGAIN/EWOULDBLOCK).
@@ -213,14 +440,167 @@ public:
       }
     } while (bytes_received > 0);
   }
+
+private:
+  // Thread de transmissão: envia a fila em rajadas e dorme quando ela
+  // esvazia, até que sendAsync() a acorde.
+  void txLoop() {
+    Buffer *bufs[TX_BURST];
+    for (;;) {
+      unsigned int n = 0;
+      while (n < TX_BURST && _tx_queue.pop(bufs[n])) {
+        n++;
+      }
+      if (n > 0) {
+        int sent = send_burst(bufs, n);
+        // Tenta um a um o que a rajada não enviou
+        for (unsigned int i = sent > 0 ? sent : 0; i < n; i++) {
+          if (send(bufs[i]) <= 0) {
+            _statistics.add(Statistics::DROP_TX_FAILED);
+          }
+        }
+        for (unsigned int i = 0; i < n; i++) {
+          free(bufs[i]);
+        }
+        continue;
+      }
+      if (!_tx_running.load()) {
+        break;
+      }
+      uint32_t seen = _tx_signal.load();
+      _tx_idle.store(true);
+      // sendAsync() vê _tx_idle ou esta thread vê o quadro enfileirado
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (!_tx_queue.empty() || !_tx_running.load()) {
+        _tx_idle.store(false);
+        continue;
+      }
+      _tx_signal.wait(seen);
+    }
+  }
+
+  // Acorda a thread de transmissão se ela estiver dormindo.
+  void wakeTx() {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (_tx_idle.load(std::memory_order_relaxed) && _tx_idle.exchange(false)) {
+      _tx_signal.fetch_add(1);
+      _tx_signal.notify_one();
+    }
+  }
+
+  // Decide se um envio de massa pode alocar um buffer. Acima da marca alta
+  // a transmissão fica contida até que free() volte à marca baixa.
+  // Returns:
+  //   true se o envio pode prosseguir.
+  bool admitBulk() {
+    if (!_tx_congested) {
+      if (_tx_in_use < _backpressure.high) {
+        return true;
+      }
+      _tx_congested = true;
+    }
+    if (_backpressure.policy == TxBackpressure::Drop) {
+      return false;
+    }
+    // free() vê _tx_congested ou esta thread vê _tx_in_use já na marca baixa
+    std::unique_lock<std::mutex> lock(_tx_mtx);
+    return _tx_cv.wait_for(lock, _backpressure.timeout, [this]() {
+      if (_tx_in_use <= _backpressure.low) {
+        _tx_congested = false;
+      }
+      return !_tx_congested;
+    });
+  }
+
+  // Drena o socket em rajadas de até Engine::RECEIVE_BURST buffers do pool,
+  // com uma chamada de receive_burst por rajada.
+  void handle_burst() {
+    Buffer *bufs[Engine::RECEIVE_BURST];
+    unsigned int received = 0;
+    unsigned int allocated = 0;
+    do {
+      // 1. Alocar a rajada de buffers para recepção.
+      for (allocated = 0; allocated < Engine::RECEIVE_BURST; allocated++) {
+        bufs[allocated] = alloc(0);
+        if (bufs[allocated] == nullptr) {
+          break;
+        }
+#ifdef DEBUG_DELAY
+        auto now = std::chrono::high_resolution_clock::now();
+        bufs[allocated]->_temp_bottom_delay = std::chrono::duration_cast<std::chrono::microseconds>(now.time_since_epoch()).count();
+#endif
+      }
+      if (allocated == 0) {
+#ifdef DEBUG
+        std::cout << "NIC buffer is full" << std::endl;
+#endif
+        break;
+      }
+
+      // 2. Receber quantos quadros houver, até o tamanho da rajada.
+      int ret = Engine::receive_burst(bufs, allocated);
+      received = ret > 0 ? ret : 0;
+
+      // 3. Entregar os recebidos e devolver os buffers não usados.
+      for (unsigned int i = 0; i < received; i++) {
+#ifdef DEBUG
+        printEth(bufs[i]);
+#endif
+        deliver(bufs[i], bufs[i]->size());
+      }
+      for (unsigned int i = received; i < allocated; i++) {
+        free(bufs[i]);
+      }
+      // Rajada cheia indica que ainda pode haver quadros no socket
+    } while (received == allocated);
+  }
+
+  // Registra a recepção de um frame e notifica os protocolos interessados.
+  void deliver(Buffer *buf, int bytes_received) {
+    // Prefere o instante registrado pelo kernel ao da thread de recepção
+    int64_t kernel_time = buf->get_kernel_time();
+    buf->set_receive_time(kernel_time ? _clock->getTimestamp(kernel_time)
+                                      : _clock->getTimestamp());
+    // Pacote recebido!
+    _statistics.addFrame(Statistics::RX_PACKETS, bytes_received);
+    bool notified = this->notify(
+        buf->template data<typename NICFrameClass::Frame>()->prot, buf);
+#ifdef DEBUG
+    std::cout << "NIC::handle_signal: "
+              << (notified ? "Protocol Notificado" : "Protocol Não notificado")
+              << std::endl;
+#endif
+    // Se NENHUM observador (Protocolo) estava interessado (registrado
+    // para este EtherType), a NIC deve liberar o buffer que alocou.
+    if (!notified) {
+      _statistics.add(Statistics::DROP_NO_OBSERVER);
+      free(buf);
+    }
+  }
+
   Buffer::BufferType buf_type{};
-  std::mutex alloc_mtx{};
   // --- Membros ---
   Statistics _statistics; // Estatísticas de rede
 
-  // Pool de Buffers
-  unsigned int last_used_send_buffer;
-  unsigned int last_used_recv_buffer;
+  // Pool de Buffers: cada NIC tem os seus, permitindo várias NICs do mesmo
+  // tipo no processo
+  std::shared_ptr<BufferPool> _send_buffer_pool;
+  std::shared_ptr<BufferPool> _small_send_pool;
+  std::shared_ptr<BufferPool> _recv_buffer_pool;
+
+  // Contrapressão na transmissão
+  TxBackpressure _backpressure;
+  std::atomic<unsigned int> _tx_in_use{ 0 }; // Buffers de envio em uso
+  std::atomic<bool> _tx_congested{ false };
+  std::mutex _tx_mtx;
+  std::condition_variable _tx_cv;
+
+  // Transmissão assíncrona
+  MpmcQueue<Buffer *> _tx_queue;
+  std::thread _tx_thread;
+  std::atomic<bool> _tx_running{ false };
+  std::atomic<bool> _tx_idle{ false };       // Thread dormindo em _tx_signal
+  std::atomic<uint32_t> _tx_signal{ 0 };
 
   SimulatedClock *_clock;
 };
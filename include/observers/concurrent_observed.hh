@@ -2,7 +2,8 @@
 #define OBSERVED_HH
 
 #include "concurrent_observer.hh"
-#include "ordered_list.hh"
+#include "observer_registry.hh"
+#include <vector>
 
 template <typename D, typename C = void>
 class Concurrent_Observed {
@@ -11,7 +12,7 @@ class Concurrent_Observed {
 public:
   typedef D Observed_Data;
   typedef C Observing_Condition;
-  using Observers = Ordered_List<Concurrent_Observer<D, C> *, C>;
+  using Observers = Observer_Registry<Concurrent_Observer<D, C>, C>;
 
 public:
   Concurrent_Observed() = default;
@@ -19,41 +20,47 @@ public:
   ~Concurrent_Observed() = default;
 
   void attach(Concurrent_Observer<D, C> *o, C c) {
-    std::lock_guard<std::mutex> lock(_mutex);
     _observers.insert(o, c);
   }
 
+  // Ao retornar, o observador não recebe mais notificações (ver
+  // Observer_Registry).
   void detach(Concurrent_Observer<D, C> *o, C c) {
-    std::lock_guard<std::mutex> lock(_mutex);
     _observers.remove(o, c);
   }
 
+  // Notifica os observadores de c, sem travas: o registro é lido de uma
+  // cópia imutável, indexada pela condição quando ela tem hash.
   bool notify(C c, D *d) {
-    std::lock_guard<std::mutex> lock(_mutex);
-    bool notified = false;
-
-    for (auto obs = _observers.begin(); obs != _observers.end(); ++obs) {
-      if (obs->rank() == c) {
-        obs->value()->update(c, d);
-        notified = true;
-      }
-    }
+    return _observers.forEach(
+        c, [&](Concurrent_Observer<D, C> *obs) { obs->update(c, d); });
+  }
 
-    return notified;
+  // Notifica todos os observadores, qualquer que seja a condição de cada
+  // um, com o mesmo dado.
+  // Args:
+  //   d: Dado entregue a todos.
+  //   share: Chamada antes de cada entrega (ex.: adiciona uma referência
+  //   ao dado, liberada pelo observador).
+  // Returns:
+  //   Quantidade de observadores notificados.
+  template <typename Share>
+  unsigned int notifyAll(D *d, Share share) {
+    return _observers.forAll([&](Concurrent_Observer<D, C> *obs, C c) {
+      share(d);
+      obs->update(c, d);
+    });
   }
 
   std::vector<C> getObservsCond() {
-    std::lock_guard<std::mutex> lock(_mutex); // Protege o acesso a _observers
     std::vector<C> ret;
-    for (auto &obs : _observers) { // Usa range-based for para simplificar
-        ret.push_back(obs.rank());
-    }
+    _observers.forAll(
+        [&](Concurrent_Observer<D, C> *, C c) { ret.push_back(c); });
     return ret;
-}
+  }
 
 private:
   Observers _observers;
-  std::mutex _mutex{};
 };
 
 #endif
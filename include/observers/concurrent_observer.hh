@@ -1,12 +1,24 @@
 #ifndef OBSERVER_HH
 #define OBSERVER_HH
 
-#include <queue>
-#include <semaphore>
+#include "mpmc_queue.hh"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <span>
 
 template <typename D, typename C>
 class Concurrent_Observed;
 
+// Observador com fila própria: update() enfileira o dado (em qualquer
+// thread) e updated() o retira, bloqueando enquanto a fila estiver vazia.
+//
+// A fila é limitada e sem travas (MpmcQueue), e várias threads podem
+// chamar updated() ao mesmo tempo. Um consumidor só dorme depois de se
+// anunciar em _sleepers, e os produtores só acordam a palavra de espera
+// (futex) quando há alguém dormindo, uma vez por sono. Com a fila cheia,
+// descarta-se o dado novo ou o mais antigo, conforme a política; o
+// descartado é entregue a discard() (ex.: para devolver o buffer ao pool).
 template <typename D, typename C>
 class Concurrent_Observer {
   friend class Concurrent_Observed<D, C>;
@@ -15,29 +27,104 @@ public:
   typedef D Observed_Data;
   typedef C Observing_Condition;
 
+  // Política de descarte com a fila cheia
+  enum Overflow { DropNewest, DropOldest };
+
+  // Capacidade padrão: comporta todos os buffers de envio e recepção das
+  // NICs de um protocolo
+  static constexpr size_t QUEUE_SIZE = 4096;
+
 public:
-  Concurrent_Observer() : _semaphore(0) {
+  Concurrent_Observer(size_t capacity = QUEUE_SIZE,
+                      Overflow overflow = DropNewest)
+      : _data(capacity), _overflow(overflow) {
   }
 
-  ~Concurrent_Observer() = default;
+  virtual ~Concurrent_Observer() = default;
 
+  // Pode ser chamado por várias threads ao mesmo tempo: o Observed notifica
+  // sem travas.
   virtual void update([[maybe_unused]] C c, D *d) {
-    _data.push(d);
-    _semaphore.release();
+    while (!_data.push(d)) {
+      _dropped.fetch_add(1, std::memory_order_relaxed);
+      if (_overflow == DropNewest) {
+        discard(d);
+        return;
+      }
+      // Abre espaço retirando o mais antigo
+      D *oldest;
+      if (_data.pop(oldest)) {
+        discard(oldest);
+      }
+    }
+    // O consumidor vê o dado ou este produtor vê o consumidor em _sleepers.
+    // Só o primeiro produtor depois que ele dormiu paga a chamada ao kernel.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (_sleepers.load(std::memory_order_relaxed) > 0 &&
+        !_woken.exchange(true)) {
+      _signal.fetch_add(1);
+      _signal.notify_all();
+    }
   }
 
+  // Retira o próximo dado, bloqueando até que haja um.
   D *updated() {
-    _semaphore.acquire();
+    D *datum;
+    while (!_data.pop(datum)) {
+      sleep();
+    }
+    return datum;
+  }
+
+  // Retira de uma vez todos os dados disponíveis, até o tamanho de out,
+  // bloqueando apenas até que haja o primeiro.
+  // Args:
+  //   out: Destino dos dados retirados.
+  // Returns:
+  //   Quantidade de dados retirados (ao menos 1 se out não for vazio).
+  size_t updated_batch(std::span<D *> out) {
+    if (out.empty()) {
+      return 0;
+    }
+    out[0] = updated();
+    size_t n = 1;
+    while (n < out.size() && _data.pop(out[n])) {
+      n++;
+    }
+    return n;
+  }
 
-    auto datum = _data.front();
-    _data.pop();
+  // Quantidade de dados descartados com a fila cheia.
+  unsigned long long dropped() const {
+    return _dropped.load(std::memory_order_relaxed);
+  }
 
-    return datum;
+protected:
+  // Recebe cada dado descartado com a fila cheia. Por padrão, nada faz.
+  virtual void discard([[maybe_unused]] D *d) {
   }
 
 private:
-  std::counting_semaphore<> _semaphore;
-  std::queue<D *> _data;
+  // Dorme até que update() sinalize, se a fila continuar vazia depois de o
+  // consumidor se anunciar.
+  void sleep() {
+    uint32_t seen = _signal.load();
+    _sleepers.fetch_add(1);
+    _woken.store(false);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (_data.empty()) {
+      _signal.wait(seen);
+    }
+    _sleepers.fetch_sub(1);
+  }
+
+  MpmcQueue<D *> _data;
+  const Overflow _overflow;
+  std::atomic<unsigned long long> _dropped{ 0 };
+  // Consumidores dormindo em _signal
+  std::atomic<unsigned int> _sleepers{ 0 };
+  std::atomic<bool> _woken{ false }; // Sinal já enviado aos que dormem
+  std::atomic<uint32_t> _signal{ 0 };
 };
 
 #endif
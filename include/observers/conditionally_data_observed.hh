@@ -2,8 +2,9 @@
 #define CONDITIONALLY_DATA_OBSERVED_HH
 
 #include "conditional_data_observer.hh"
-#include "ordered_list.hh"
+#include "observer_registry.hh"
 #include <forward_list>
+#include <mutex>
 
 template <typename T, typename Condition = void>
 class Conditionally_Data_Observed {
@@ -11,36 +12,26 @@ class Conditionally_Data_Observed {
 
 public:
   using Observer = Conditional_Data_Observer<T, Condition>;
-  using Observers = Ordered_List<Observer *, Condition>;
+  using Observers = Observer_Registry<Observer, Condition>;
   using Observed_Data = T;
 
 public:
   virtual void attach(Observer *o, Condition c) {
-    std::lock_guard<std::mutex> lock(_mutex);
     _observers.insert(o, c);
   }
 
   virtual void detach(Observer *o, Condition c) {
-    std::lock_guard<std::mutex> lock(_mutex);
     _observers.remove(o, c);
   }
 
+  // Notifica os observadores de c sem travas (ver Observer_Registry): um
+  // observador lento não impede attach/detach nem as demais notificações.
   virtual bool notify(Condition c, Observed_Data *d) {
-    bool notified = false;
-    std::lock_guard<std::mutex> lock(_mutex);
-
-    for (const auto &obs : _observers) {
-        if (obs.rank() == c) {
-            obs.value()->update(this, c, d);
-            notified = true;
-        }
-    }
+    return _observers.forEach(c,
+                              [&](Observer *obs) { obs->update(this, c, d); });
+  }
 
-    return notified;
-}
-  
-  private:
-  std::mutex _mutex{};
+private:
   Observers _observers;
 };
 
@@ -0,0 +1,220 @@
+#ifndef OBSERVER_REGISTRY_HH
+#define OBSERVER_REGISTRY_HH
+
+#include "ordered_list.hh"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+// Condições com std::hash ganham um índice condição -> observadores.
+// As demais (ex.: Condition, cuja igualdade não é simétrica) são comparadas
+// uma a uma, como antes.
+template <typename C>
+concept Hashable_Condition = requires(const C &c) {
+  { std::hash<C>{}(c) } -> std::convertible_to<std::size_t>;
+};
+
+// Registro de observadores no estilo RCU. Os leitores (notify) percorrem
+// uma cópia imutável do registro, trocada atomicamente, sem travas. Os
+// escritores (attach/detach) copiam o registro, alteram a cópia, publicam-na
+// e só liberam a anterior quando nenhum leitor pode mais estar usando-a.
+//
+// Os leitores se anunciam em um de dois contadores, escolhido pela época
+// atual. Depois de publicar a nova cópia, o escritor alterna a época e
+// espera o contador antigo zerar, duas vezes: ao final, todo leitor que
+// viu a cópia anterior já terminou. Assim, depois que detach retorna, o
+// observador removido não recebe mais update() e pode ser destruído.
+//
+// Uma escrita feita dentro de uma leitura do mesmo registro, na mesma
+// thread (ex.: observador que se remove em update()), esperaria por si
+// mesma. Ela é adiada até o fim da leitura mais externa desse registro na
+// thread e só então passa a valer, com a garantia acima. Escritas em outro
+// registro não são adiadas: esperam os leitores dele normalmente.
+template <typename O, typename C>
+class Observer_Registry {
+  // Índice condição -> observadores, ausente para condições sem hash
+  struct No_Index {};
+  using Index = std::conditional_t<Hashable_Condition<C>,
+                                   std::unordered_map<C, std::vector<O *>>,
+                                   No_Index>;
+
+  struct Snapshot {
+    Ordered_List<O *, C> all;
+    Index index;
+  };
+
+public:
+  Observer_Registry() : _current(new Snapshot()) {
+  }
+
+  ~Observer_Registry() {
+    delete _current.load();
+  }
+
+  Observer_Registry(const Observer_Registry &) = delete;
+  Observer_Registry &operator=(const Observer_Registry &) = delete;
+
+  void insert(O *o, C c) {
+    update([o, c](Snapshot &s) {
+      s.all.insert(o, c);
+      if constexpr (Hashable_Condition<C>) {
+        s.index[c].push_back(o);
+      }
+    });
+  }
+
+  void remove(O *o, C c) {
+    update([o, c](Snapshot &s) {
+      s.all.remove(o, c);
+      if constexpr (Hashable_Condition<C>) {
+        auto it = s.index.find(c);
+        if (it != s.index.end()) {
+          std::erase(it->second, o);
+          if (it->second.empty()) {
+            s.index.erase(it);
+          }
+        }
+      }
+    });
+  }
+
+  // Chama f(observador) para cada observador de c, sem travas.
+  // Returns:
+  //   true se algum observador foi encontrado.
+  template <typename F>
+  bool forEach(const C &c, F f) {
+    Read_Guard guard(*this);
+    const Snapshot *s = guard.snapshot();
+    bool found = false;
+    if constexpr (Hashable_Condition<C>) {
+      auto it = s->index.find(c);
+      if (it != s->index.end()) {
+        for (O *o : it->second) {
+          f(o);
+          found = true;
+        }
+      }
+    } else {
+      for (const auto &node : s->all) {
+        if (node.rank() == c) {
+          f(node.value());
+          found = true;
+        }
+      }
+    }
+    return found;
+  }
+
+  // Chama f(observador, condição) para todos os observadores, sem travas.
+  // Returns:
+  //   Quantidade de observadores.
+  template <typename F>
+  unsigned int forAll(F f) {
+    Read_Guard guard(*this);
+    unsigned int count = 0;
+    for (const auto &node : guard.snapshot()->all) {
+      f(node.value(), node.rank());
+      count++;
+    }
+    return count;
+  }
+
+private:
+  using Change = std::function<void(Snapshot &)>;
+
+  // Seção de leitura: anuncia o leitor no contador da época atual. As
+  // seções abertas pela thread formam uma pilha (_outer), usada para saber
+  // se a thread está lendo um dado registro.
+  class Read_Guard {
+  public:
+    Read_Guard(Observer_Registry &r) : _r(r), _outer(_innermost) {
+      _slot = _r._epoch.load() & 1;
+      _r._readers[_slot].count.fetch_add(1);
+      _innermost = this;
+      _snapshot = _r._current.load();
+    }
+
+    ~Read_Guard() {
+      _innermost = _outer;
+      _r._readers[_slot].count.fetch_sub(1, std::memory_order_release);
+      // Esta era a leitura mais externa do registro na thread
+      for (Change &change : _deferred) {
+        _r.update(change);
+      }
+    }
+
+    const Snapshot *snapshot() const {
+      return _snapshot;
+    }
+
+    // Seção mais externa aberta pela thread sobre r, ou nullptr.
+    static Read_Guard *outermost(const Observer_Registry *r) {
+      Read_Guard *found = nullptr;
+      for (Read_Guard *g = _innermost; g != nullptr; g = g->_outer) {
+        if (&g->_r == r) {
+          found = g;
+        }
+      }
+      return found;
+    }
+
+    // Guarda uma escrita para o fim desta seção.
+    void defer(Change change) {
+      _deferred.push_back(std::move(change));
+    }
+
+  private:
+    Observer_Registry &_r;
+    Read_Guard *_outer;
+    unsigned int _slot;
+    const Snapshot *_snapshot;
+    std::vector<Change> _deferred;
+  };
+
+  // Copia o registro, aplica change, publica a cópia e espera os leitores
+  // da anterior antes de liberá-la. Dentro de uma leitura deste registro
+  // na mesma thread, a escrita é adiada (ver Read_Guard).
+  template <typename F>
+  void update(F change) {
+    if (Read_Guard *reader = Read_Guard::outermost(this)) {
+      reader->defer(Change(change));
+      return;
+    }
+    std::lock_guard<std::mutex> lock(_writer);
+    Snapshot *next = new Snapshot(*_current.load());
+    change(*next);
+    Snapshot *previous = _current.exchange(next);
+    synchronize();
+    delete previous;
+  }
+
+  // Espera que todo leitor que possa ter visto uma cópia anterior termine.
+  void synchronize() {
+    for (int i = 0; i < 2; i++) {
+      unsigned int slot = _epoch.fetch_add(1) & 1;
+      while (_readers[slot].count.load(std::memory_order_acquire) != 0) {
+        std::this_thread::yield();
+      }
+    }
+  }
+
+  struct alignas(64) Reader_Count {
+    std::atomic<unsigned int> count{ 0 };
+  };
+
+  std::atomic<Snapshot *> _current;
+  std::atomic<unsigned int> _epoch{ 0 };
+  Reader_Count _readers[2];
+
+  std::mutex _writer;
+  // Seção de leitura mais interna aberta pela thread (em qualquer registro
+  // deste tipo)
+  inline static thread_local Read_Guard *_innermost = nullptr;
+};
+
+#endif
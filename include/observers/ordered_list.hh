@@ -61,10 +61,12 @@ public:
 
   Ordered_List() = default;
 
+  // Insere após os nós de mesmo rank, mantendo a ordem sem reordenar a
+  // lista inteira.
   void insert(D d, C c) {
     Ordered_Node<D, C> new_node(d, c);
-    _list.push_back(new_node);
-    std::sort(_list.begin(), _list.end());
+    _list.insert(std::upper_bound(_list.begin(), _list.end(), new_node),
+                 new_node);
   }
 
   void remove(D d, C c) {
@@ -0,0 +1,349 @@
+#ifndef PACKET_RING_HH
+#define PACKET_RING_HH
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+
+#include <linux/if_packet.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+
+// Anel de recepção PACKET_RX_RING (TPACKET_V3) mapeado em memória.
+// O kernel preenche blocos com vários quadros e os entrega ao usuário quando
+// o bloco enche ou quando o timeout do bloco expira. Os quadros são
+// percorridos no próprio anel (sem cópia) e o bloco só volta ao kernel depois
+// que todos os quadros entregues foram liberados.
+class RxRing {
+public:
+  RxRing() = default;
+
+  ~RxRing() {
+    if (_map != nullptr) {
+      munmap(_map, _map_size);
+    }
+  }
+
+  RxRing(const RxRing &) = delete;
+  RxRing &operator=(const RxRing &) = delete;
+
+  // Configura o anel no socket e mapeia a memória.
+  // Deve ser chamado antes do bind do socket.
+  // Args:
+  //   fd: socket AF_PACKET.
+  //   block_size: tamanho de cada bloco (múltiplo do tamanho de página).
+  //   block_count: número de blocos do anel.
+  //   frame_size: tamanho de referência de um quadro (TPACKET_ALIGNMENT).
+  //   timeout_ms: tempo máximo que o kernel segura um bloco incompleto.
+  // Returns:
+  //   true em caso de sucesso.
+  bool setup(int fd, unsigned int block_size, unsigned int block_count,
+             unsigned int frame_size, unsigned int timeout_ms) {
+    int version = TPACKET_V3;
+    if (setsockopt(fd, SOL_PACKET, PACKET_VERSION, &version,
+                   sizeof(version)) < 0) {
+      return false;
+    }
+
+    struct tpacket_req3 req;
+    std::memset(&req, 0, sizeof(req));
+    req.tp_block_size = block_size;
+    req.tp_block_nr = block_count;
+    req.tp_frame_size = frame_size;
+    req.tp_frame_nr = (block_size * block_count) / frame_size;
+    req.tp_retire_blk_tov = timeout_ms;
+    if (setsockopt(fd, SOL_PACKET, PACKET_RX_RING, &req, sizeof(req)) < 0) {
+      return false;
+    }
+
+    _map_size = static_cast<size_t>(block_size) * block_count;
+    void *map = mmap(nullptr, _map_size, PROT_READ | PROT_WRITE,
+                     MAP_SHARED | MAP_POPULATE, fd, 0);
+    if (map == MAP_FAILED) {
+      return false;
+    }
+    _map = static_cast<std::byte *>(map);
+    _block_size = block_size;
+    _block_count = block_count;
+    _refs = std::make_unique<std::atomic<int>[]>(block_count);
+    _owned = std::make_unique<std::atomic<bool>[]>(block_count);
+    return true;
+  }
+
+  // Retorna o próximo quadro disponível no anel.
+  // Deve ser chamado sempre pela mesma thread (thread de recepção).
+  // Args:
+  //   len: recebe o tamanho do quadro.
+  //   block: recebe o índice do bloco, usado depois em release().
+  //   timestamp: recebe o instante de recepção registrado pelo kernel (us).
+  // Returns:
+  //   Ponteiro para o início do quadro (cabeçalho Ethernet) ou nullptr se o
+  //   kernel ainda não entregou nenhum bloco.
+  std::byte *next(int &len, int &block, int64_t &timestamp) {
+    while (true) {
+      if (!_walking) {
+        if (_owned[_cur_block].load(std::memory_order_acquire) ||
+            !(blockStatus(_cur_block).load(std::memory_order_acquire) &
+              TP_STATUS_USER)) {
+          return nullptr;
+        }
+        tpacket_block_desc *desc = blockDesc(_cur_block);
+        // Referência do próprio percurso, solta quando o bloco acaba
+        _refs[_cur_block].store(1, std::memory_order_relaxed);
+        _owned[_cur_block].store(true, std::memory_order_relaxed);
+        _remaining = desc->hdr.bh1.num_pkts;
+        _cur_frame = reinterpret_cast<tpacket3_hdr *>(
+            reinterpret_cast<std::byte *>(desc) +
+            desc->hdr.bh1.offset_to_first_pkt);
+        _walking = true;
+      }
+
+      if (_remaining == 0) {
+        unsigned int done = _cur_block;
+        _walking = false;
+        _cur_block = (_cur_block + 1) % _block_count;
+        release(done);
+        continue;
+      }
+
+      tpacket3_hdr *frame = _cur_frame;
+      if (--_remaining > 0) {
+        _cur_frame = reinterpret_cast<tpacket3_hdr *>(
+            reinterpret_cast<std::byte *>(frame) + frame->tp_next_offset);
+      }
+      _refs[_cur_block].fetch_add(1, std::memory_order_relaxed);
+      len = frame->tp_snaplen;
+      block = _cur_block;
+      timestamp = static_cast<int64_t>(frame->tp_sec) * 1000000 +
+                  frame->tp_nsec / 1000;
+      return reinterpret_cast<std::byte *>(frame) + frame->tp_mac;
+    }
+  }
+
+  // Indica se next() tem um quadro a entregar, sem consumi-lo.
+  // Deve ser chamado pela mesma thread que chama next().
+  bool pending() {
+    if (_map == nullptr) {
+      return false;
+    }
+    if (_walking && _remaining > 0) {
+      return true;
+    }
+    unsigned int block =
+        _walking ? (_cur_block + 1) % _block_count : _cur_block;
+    return !_owned[block].load(std::memory_order_acquire) &&
+           (blockStatus(block).load(std::memory_order_acquire) &
+            TP_STATUS_USER);
+  }
+
+  // Indica se o ponteiro aponta para dentro deste anel.
+  bool owns(const std::byte *ptr) const {
+    return _map != nullptr && ptr >= _map && ptr < _map + _map_size;
+  }
+
+  // Solta uma referência do bloco. Quando a última referência é solta o
+  // bloco é devolvido ao kernel. Pode ser chamado de qualquer thread.
+  void release(int block) {
+    if (_refs[block].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      blockStatus(block).store(TP_STATUS_KERNEL, std::memory_order_release);
+      _owned[block].store(false, std::memory_order_release);
+    }
+  }
+
+private:
+  tpacket_block_desc *blockDesc(unsigned int block) {
+    return reinterpret_cast<tpacket_block_desc *>(
+        _map + static_cast<size_t>(block) * _block_size);
+  }
+
+  std::atomic_ref<uint32_t> blockStatus(unsigned int block) {
+    return std::atomic_ref<uint32_t>(blockDesc(block)->hdr.bh1.block_status);
+  }
+
+  std::byte *_map = nullptr;
+  size_t _map_size = 0;
+  unsigned int _block_size = 0;
+  unsigned int _block_count = 0;
+
+  // Referências pendentes (quadros não liberados + percurso) por bloco
+  std::unique_ptr<std::atomic<int>[]> _refs;
+  // Bloco ainda em posse do usuário (não devolvido ao kernel)
+  std::unique_ptr<std::atomic<bool>[]> _owned;
+
+  // ---- Estado do percurso (apenas thread de recepção) ----
+  unsigned int _cur_block = 0;
+  unsigned int _remaining = 0;
+  tpacket3_hdr *_cur_frame = nullptr;
+  bool _walking = false;
+};
+
+// Anel de transmissão PACKET_TX_RING (TPACKET_V2) mapeado em memória.
+// Os slots são reservados em ordem, preenchidos no próprio anel e marcados
+// para envio. Um único sendto (kick) envia todos os slots marcados: quando
+// várias threads estão enviando ao mesmo tempo, apenas a última a terminar
+// faz o kick, que descarrega a rajada inteira.
+class TxRing {
+public:
+  TxRing() = default;
+
+  ~TxRing() {
+    if (_map != nullptr) {
+      munmap(_map, _map_size);
+    }
+  }
+
+  TxRing(const TxRing &) = delete;
+  TxRing &operator=(const TxRing &) = delete;
+
+  // Configura o anel no socket e mapeia a memória.
+  // Deve ser chamado antes do bind do socket.
+  // Args:
+  //   fd: socket AF_PACKET usado apenas para transmissão.
+  //   frame_size: tamanho de cada slot (cabeçalho + quadro).
+  //   frame_count: número de slots do anel.
+  // Returns:
+  //   true em caso de sucesso.
+  bool setup(int fd, unsigned int frame_size, unsigned int frame_count) {
+    int version = TPACKET_V2;
+    if (setsockopt(fd, SOL_PACKET, PACKET_VERSION, &version,
+                   sizeof(version)) < 0) {
+      return false;
+    }
+
+    // Slots descartados (ver discard) são pulados pelo kernel em vez de
+    // travar o anel
+    int loss = 1;
+    if (setsockopt(fd, SOL_PACKET, PACKET_LOSS, &loss, sizeof(loss)) < 0) {
+      return false;
+    }
+
+    unsigned int block_size = static_cast<unsigned int>(getpagesize());
+    while (block_size < frame_size) {
+      block_size <<= 1;
+    }
+    unsigned int frames_per_block = block_size / frame_size;
+
+    struct tpacket_req req;
+    std::memset(&req, 0, sizeof(req));
+    req.tp_block_size = block_size;
+    req.tp_block_nr =
+        (frame_count + frames_per_block - 1) / frames_per_block;
+    req.tp_frame_size = frame_size;
+    req.tp_frame_nr = req.tp_block_nr * frames_per_block;
+    if (setsockopt(fd, SOL_PACKET, PACKET_TX_RING, &req, sizeof(req)) < 0) {
+      return false;
+    }
+
+    _map_size = static_cast<size_t>(block_size) * req.tp_block_nr;
+    void *map = mmap(nullptr, _map_size, PROT_READ | PROT_WRITE,
+                     MAP_SHARED | MAP_POPULATE, fd, 0);
+    if (map == MAP_FAILED) {
+      return false;
+    }
+    _map = static_cast<std::byte *>(map);
+    _block_size = block_size;
+    _frame_size = frame_size;
+    _frames_per_block = frames_per_block;
+    _frame_count = req.tp_frame_nr;
+    _reserved = std::make_unique<std::atomic<bool>[]>(_frame_count);
+    return true;
+  }
+
+  // Reserva o próximo slot do anel. Os slots são entregues em ordem, pois o
+  // kernel percorre o anel sequencialmente.
+  // Args:
+  //   slot: recebe o índice do slot reservado.
+  // Returns:
+  //   Ponteiro para a área do quadro no slot ou nullptr se o anel estiver
+  //   cheio (kernel ainda enviando o slot da vez) ou não configurado.
+  std::byte *reserve(int &slot) {
+    std::lock_guard<std::mutex> lock(_reserve_mtx);
+    // Anel ainda não configurado (Engine em construção)
+    if (_map == nullptr) {
+      return nullptr;
+    }
+    unsigned int i = _head;
+    if (_reserved[i].load(std::memory_order_relaxed) ||
+        (status(i).load(std::memory_order_acquire) &
+         (TP_STATUS_SEND_REQUEST | TP_STATUS_SENDING))) {
+      return nullptr;
+    }
+    _reserved[i].store(true, std::memory_order_relaxed);
+    _in_flight.fetch_add(1, std::memory_order_acq_rel);
+    _head = (_head + 1) % _frame_count;
+    slot = i;
+    return frameData(i);
+  }
+
+  // Marca um slot reservado para envio.
+  // Returns:
+  //   true se o chamador é o último envio em andamento e deve fazer o kick.
+  bool submit(int slot, unsigned int len) {
+    frameHdr(slot)->tp_len = len;
+    return finish(slot);
+  }
+
+  // Devolve um slot reservado que não foi enviado. O slot vai ao kernel com
+  // tamanho zero e é pulado (PACKET_LOSS), mantendo a ordem do anel.
+  // Returns:
+  //   true se o chamador deve fazer o kick.
+  bool discard(int slot) {
+    if (!_reserved[slot].load(std::memory_order_acquire)) {
+      return false;
+    }
+    frameHdr(slot)->tp_len = 0;
+    return finish(slot);
+  }
+
+  // Verifica se o endereço pertence à memória do anel.
+  bool owns(const std::byte *ptr) const {
+    return _map != nullptr && ptr >= _map && ptr < _map + _map_size;
+  }
+
+  unsigned int frameCapacity() const {
+    return _frame_size - (TPACKET2_HDRLEN - sizeof(struct sockaddr_ll));
+  }
+
+private:
+  bool finish(int slot) {
+    status(slot).store(TP_STATUS_SEND_REQUEST, std::memory_order_release);
+    _reserved[slot].store(false, std::memory_order_release);
+    return _in_flight.fetch_sub(1, std::memory_order_acq_rel) == 1;
+  }
+
+  tpacket2_hdr *frameHdr(unsigned int slot) {
+    unsigned int block = slot / _frames_per_block;
+    unsigned int offset = (slot % _frames_per_block) * _frame_size;
+    return reinterpret_cast<tpacket2_hdr *>(
+        _map + static_cast<size_t>(block) * _block_size + offset);
+  }
+
+  // No TX o quadro começa logo após o cabeçalho alinhado do slot
+  std::byte *frameData(unsigned int slot) {
+    return reinterpret_cast<std::byte *>(frameHdr(slot)) + TPACKET2_HDRLEN -
+           sizeof(struct sockaddr_ll);
+  }
+
+  std::atomic_ref<uint32_t> status(unsigned int slot) {
+    return std::atomic_ref<uint32_t>(frameHdr(slot)->tp_status);
+  }
+
+  std::byte *_map = nullptr;
+  size_t _map_size = 0;
+  unsigned int _block_size = 0;
+  unsigned int _frame_size = 0;
+  unsigned int _frames_per_block = 0;
+  unsigned int _frame_count = 0;
+
+  std::mutex _reserve_mtx;
+  unsigned int _head = 0;
+  // Slot reservado por um chamador e ainda não enviado/descartado
+  std::unique_ptr<std::atomic<bool>[]> _reserved;
+  // Slots reservados cujo envio ainda não foi marcado
+  std::atomic<int> _in_flight = 0;
+};
+
+#endif
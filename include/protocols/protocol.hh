@@ -7,6 +7,7 @@
 #include "mac_structs.hh"
 #include "navigator.hh"
 #include "protocol_commom.hh"
+#include <atomic>
 #include <bit>
 #include <cstddef>
 
@@ -39,9 +40,10 @@ public:
   ~Protocol() {
   }
 
-protected:
   // Construtor: associa o protocolo à NIC e registra-se como observador do
-  // protocolo PROTO
+  // protocolo PROTO. Cada instância tem suas próprias NICs, então várias
+  // pilhas podem coexistir no processo (ex.: uma por interface);
+  // getInstance() continua oferecendo a instância única do processo.
   Protocol(const char *interface_name, SysID sysID,
            const std::vector<Coordinate> &points, Topology topology,
            double comm_range, double speed = 1)
@@ -49,39 +51,13 @@ protected:
              speed) {
   }
 
+protected:
+
   // Método update: chamado pela NIC quando um frame é recebido.
   // Agora com 3 parâmetros: o Observed, o protocolo e o buffer.
   void update([[maybe_unused]] typename SocketNIC::Observed *obs,
               [[maybe_unused]] typename SocketNIC::Protocol_Number prot,
               Buffer *buf) override {
-    auto handlePacket = [this](auto &nic, Buffer *buf, Port port) {
-      if (port == Base::BROADCAST) {
-        std::vector<Port> allComPorts = Base::Observed::getObservsCond();
-        Buffer *broadcastBuf;
-        for (auto port : allComPorts) {
-          broadcastBuf = nic.alloc(0);
-          if (broadcastBuf == nullptr)
-            continue;
-          if (buf->type() == Buffer::EthernetFrame) {
-            std::memcpy(broadcastBuf->template data<char>(), buf->template data<FullPacket>(), buf->size());
-          } else {
-            std::memcpy(broadcastBuf->template data<char>(), buf->template data<LitePacket>(), buf->size());
-          }
-          broadcastBuf->set_receive_time(buf->get_receive_time());
-          broadcastBuf->setSize(buf->size());
-#ifdef DEBUG_DELAY
-          broadcastBuf->_temp_bottom_delay = buf->_temp_bottom_delay;
-#endif
-          if (!this->notify(port, broadcastBuf)) {
-            nic.free(broadcastBuf);
-          }
-        }
-        nic.free(buf);
-      } else if (!this->notify(port, buf)) {
-        nic.free(buf);
-      }
-    };
-
     if (buf->type() == Buffer::EthernetFrame) {
       FullPacket *pkt = buf->template data<typename Base::SocketFrame>()->template data<FullPacket>();
       SysID destSysId = pkt->header()->dest.getSysID();
@@ -91,7 +67,7 @@ protected:
       Control::Type pkt_type = pkt->header()->ctrl.getType();
   
       if (destSysId != Base::_sysID && destSysId != Base::UNIVERSAL_BROADCAST && destSysId != Base::EXT_BROADCAST) {
-        Base::_rsnic.free(buf);
+        Base::drop(buf, NICStatistics::DROP_SYSID);
         return;
       }
 
@@ -115,8 +91,7 @@ protected:
         }
 #endif
         pkt->header()->tag = {};
-        auto msg = std::bit_cast<std::array<std::byte, sizeof(FullPacket)>>(*pkt);
-        std::vector<std::byte> msg_vec(msg.begin(), msg.end());
+        std::vector<std::byte> msg_vec = macMessage(pkt);
 #ifdef DEBUG_MAC
         if (pkt_type == Control::Type::COMMON) {
           auto exp_tag = MAC::compute(key, msg_vec);
@@ -135,7 +110,7 @@ protected:
         }
 #endif
 #ifndef DEBUG_MAC
-        Base::free(buf);
+        Base::drop(buf, NICStatistics::DROP_MAC);
         return;
 #endif
         }
@@ -143,7 +118,7 @@ protected:
 
       // Se não é uma mensagem de uma RSU, trata com o range do carro
       if (notFromRSU && !Base::_nav.is_in_range({ coord_x, coord_y })) {
-        Base::free(buf);
+        Base::drop(buf, NICStatistics::DROP_OUT_OF_RANGE);
         return;
       }
 
@@ -154,7 +129,7 @@ protected:
         auto quadrant =
             Base::_nav.get_topology().get_quadrant_id(Base::_nav.get_location());
         if (quadrant_rsu != quadrant) {
-          Base::free(buf);
+          Base::drop(buf, NICStatistics::DROP_QUADRANT);
           return;
         }
       }
@@ -162,9 +137,15 @@ protected:
       // Se é uma mensagem PTP, trata PTP
       if (pkt_type == Control::Type::DELAY_RESP ||
           pkt_type == Control::Type::LATE_SYNC) {
+        // Dados: timestamp do pedido e, no Delay Resp, o instante de saída
+        // do Late Sync
+        int64_t *ptp_data = pkt->template data<int64_t>();
+        int64_t sync_tx_time =
+            pkt->header()->payloadSize >= 2 * sizeof(int64_t) ? ptp_data[1]
+                                                              : 0;
         Base::_sync_engine.handlePTP(buf->get_receive_time(), pkt->header()->timestamp,
                                       pkt->header()->origin, pkt_type,
-                                      *pkt->template data<int64_t>());
+                                      ptp_data[0], sync_tx_time);
       }
 
       // Se é uma mensagem de chaves MAC, armazena chaves MAC
@@ -199,11 +180,11 @@ protected:
         return;
       }
 
-      handlePacket(Base::_rsnic, buf, port);
+      Base::dispatch(Base::_rsnic, buf, port);
     } else {
       LitePacket *lite_pkt = buf->template data<typename Base::SharedMFrame>()->template data<LitePacket>();
       Port port = lite_pkt->header()->dest;
-      handlePacket(Base::_smnic, buf, port);
+      Base::dispatch(Base::_smnic, buf, port);
     }
   }
 
@@ -233,10 +214,12 @@ protected:
       std::memcpy(pkt->template data<char>(), data, size);
     }
 
+    // O buffer pode ser um slot reaproveitado do anel de transmissão, então
+    // o tag antigo precisa ser zerado antes de calcular o novo
+    pkt->header()->tag = {};
     MAC::Key key =
         _key_keeper.getKey(Base::_nav.get_topology().get_quadrant_id({ x, y }));
-    auto msg = std::bit_cast<std::array<std::byte, sizeof(FullPacket)>>(*pkt);
-    std::vector<std::byte> msg_vec(msg.begin(), msg.end());
+    std::vector<std::byte> msg_vec = macMessage(pkt);
     auto tag = MAC::compute(key, msg_vec);
 #ifdef DEBUG_MAC
     tag = MAC::Tag{};
@@ -245,7 +228,18 @@ protected:
   }
 
 private:
-  bool received_first_keys;
+  // Bytes cobertos pelo MAC: cabeçalho e payload efetivo. O restante do MTU
+  // não entra, pois pode conter lixo quando o quadro está na memória da
+  // Engine (ex.: anel mmap).
+  static std::vector<std::byte> macMessage(FullPacket *pkt) {
+    std::size_t size =
+        sizeof(typename Base::FullHeader) +
+        std::min<std::size_t>(pkt->header()->payloadSize, FullPacket::MTU);
+    std::byte *begin = reinterpret_cast<std::byte *>(pkt);
+    return std::vector<std::byte>(begin, begin + size);
+  }
+
+  std::atomic<bool> received_first_keys = false;
   KeyKeeper _key_keeper;
 };
 
@@ -7,8 +7,12 @@
 #include "control.hh"
 #include "mac.hh"
 #include "navigator.hh"
+#include "nic.hh"
+#include "statistics.hh"
 #include "sync_engine.hh"
+#include <atomic>
 #include <cstring>
+#include <mutex>
 #include <netinet/in.h>
 
 #ifdef DEBUG
@@ -162,13 +166,24 @@ protected:
         _rsnic(interface_name, _sync_engine.getClock()),
         _smnic(interface_name, _sync_engine.getClock()), _sysID(sysID),
         _nav(points, topology, comm_range, speed) {
+    // Filtra no kernel os quadros enviados por este sistema e os destinados a
+    // outros sistemas. Os próprios broadcasts já são entregues pela memória
+    // compartilhada.
+    constexpr unsigned int origin_sysid =
+        sizeof(SocketNICHeader) + sizeof(Physical_Address);
+    constexpr unsigned int dest_sysid = origin_sysid + sizeof(Address);
+    _rsnic.filterSysID(origin_sysid, dest_sysid, _sysID,
+                       { UNIVERSAL_BROADCAST, EXT_BROADCAST });
+    updateQuadrant();
     _rsnic.attach(this, PROTO);
     _smnic.attach(this, PROTO);
+    _sync_engine.start();
   }
 
 public:
   // Destrutor: remove o protocolo da NIC
   ~ProtocolCommom() {
+    _sync_engine.stop();
     _rsnic.detach(this, PROTO);
     _smnic.detach(this, PROTO);
   }
@@ -192,6 +207,17 @@ public:
   Physical_Address getNICPAddr() {
     return _rsnic.address();
   }
+
+  // Liga ou desliga a transmissão assíncrona da NIC de sockets: mensagens
+  // sem timestamp de transmissão passam a ser enviadas em rajadas por uma
+  // thread da NIC, sem que o remetente espere pela chamada de sistema.
+  void setAsyncTx(bool enabled) {
+    if (enabled) {
+      _rsnic.startAsyncTx();
+    } else {
+      _rsnic.stopAsyncTx();
+    }
+  }
   SysID getSysID() {
     return _sysID;
   }
@@ -235,6 +261,19 @@ public:
     }
   }
 
+  // Descarta um quadro recebido, registrando o motivo nas estatísticas da
+  // NIC de origem.
+  // Args:
+  //   reason: Motivo do descarte (NICStatistics::DROP_*).
+  void drop(Buffer *buf, NICStatistics::Counter reason) {
+    if (buf->type() == Buffer::EthernetFrame) {
+      _rsnic.countDrop(reason);
+    } else {
+      _smnic.countDrop(reason);
+    }
+    free(buf);
+  }
+
   // Envia uma mensagem:
   // Aloca um buffer (que é um SocketFrame), interpreta o payload (após o
   // cabeçalho Ethernet) como um Packet, monta o pacote e delega o envio à NIC.
@@ -248,7 +287,7 @@ public:
       int ret_rsnic = -1;
       _sync_engine.setBroadcastAlreadySent(true);
       ret_rsnic = sendSocket(from, to, ctrl, data, size, recv_timestamp);
-      ret_smnic = sendSharedMem(from_port, to_port, ctrl, data, size);
+      ret_smnic = sendLocal(from_port, to_port, ctrl, data, size);
       if (ret_smnic == -1 && ret_rsnic == -1)
         return -1;
       return ret_smnic >= ret_rsnic ? ret_smnic : ret_rsnic;
@@ -258,7 +297,7 @@ public:
 
     // Regular send: choose appropriate NIC
     return (to.getSysID() == _sysID)
-               ? sendSharedMem(from_port, to_port, ctrl, data, size)
+               ? sendLocal(from_port, to_port, ctrl, data, size)
                : sendSocket(from, to, ctrl, data, size, recv_timestamp);
   }
 
@@ -341,11 +380,16 @@ public:
   }
 #endif
 
-private:
+protected:
+  // Envia pela NIC de sockets. Se tx_time não for nulo, recebe o instante
+  // em que o quadro saiu pela rede (timestamp de transmissão do kernel).
   int sendSocket(Address &from, Address &to, Control &ctrl,
                  void *data = nullptr, unsigned int size = 0,
-                 int64_t recv_timestamp = 0) {
-    Buffer *buf = _rsnic.alloc(1);
+                 int64_t recv_timestamp = 0, int64_t *tx_time = nullptr) {
+    Buffer *buf = _rsnic.alloc(1,
+                               sizeof(SocketNICHeader) + sizeof(FullHeader) +
+                                   size,
+                               txClass(ctrl));
     if (buf == nullptr)
       return -1;
 #ifdef DEBUG_DELAY
@@ -354,6 +398,7 @@ private:
 #endif
     ctrl.setSynchronized(_sync_engine.getSynced());
     ctrl.setNeedSync(_sync_engine.getNeedSync());
+    updateQuadrant();
     fillFullPacket(buf, from, to, ctrl, data, size);
     if (recv_timestamp) {
       if (buf->type() == Buffer::EthernetFrame) {
@@ -363,18 +408,86 @@ private:
             ->timestamp = recv_timestamp;
       }
     }
-    int ret = _rsnic.send(buf);
+    int ret;
+    if (tx_time != nullptr) {
+      ret = _rsnic.sendTimestamped(buf, *tx_time);
+    } else if (ctrl.needSync() && _sync_engine.measuresDelayReq()) {
+      // A RSU responde a esta mensagem: anota quando ela realmente saiu
+      int64_t sent_at = buf->template data<SocketFrame>()
+                            ->template data<FullPacket>()
+                            ->header()
+                            ->timestamp;
+      _sync_engine.beginDelayReq(sent_at);
+      int64_t sent_tx = 0;
+      ret = _rsnic.sendTimestamped(buf, sent_tx);
+      _sync_engine.setDelayReqTxTime(sent_at, sent_tx);
+    } else {
+      // A NIC libera o buffer, possivelmente na thread de transmissão
+      return _rsnic.sendAsync(buf);
+    }
     _rsnic.free(buf);
     return ret;
   }
 
-  int sendSharedMem(Port &from, Port &to, Control &ctrl, void *data = nullptr,
-                    unsigned int size = 0) {
-    Buffer *buf = _smnic.alloc(1);
+  // Mensagens COMMON são tráfego de massa, contido pela contrapressão da
+  // NIC; as demais (PUBLISH, PTP, chaves MAC...) são prioritárias.
+  static TxClass txClass(Control &ctrl) {
+    return ctrl.getType() == Control::Type::COMMON ? TxClass::Bulk
+                                                   : TxClass::Priority;
+  }
+
+  // Informa à NIC de sockets o quadrante atual, caso ele tenha mudado. Engines
+  // que separam o tráfego por quadrante passam a enviar para o novo quadrante
+  // e a escutar apenas ele e seus vizinhos; o alcance continua sendo
+  // verificado na recepção.
+  void updateQuadrant() {
+    Topology topology = _nav.get_topology();
+    int quadrant = topology.get_quadrant_id(_nav.get_location());
+    if (_quadrant.exchange(quadrant) != quadrant) {
+      // Quem entra por último aplica o valor mais recente
+      std::lock_guard<std::mutex> lock(_quadrant_mtx);
+      quadrant = _quadrant.load();
+      _rsnic.setQuadrant(quadrant, topology.get_neighborhood(quadrant));
+    }
+  }
+
+  // Entrega uma mensagem a portas do próprio sistema. O quadro é montado
+  // em um buffer da NIC de memória compartilhada, como antes, mas vai
+  // direto para a fila do Communicator de destino na thread do remetente,
+  // sem passar pela SharedEngine, pela NIC e por update().
+  // O buffer vem do pool de recepção: quem o devolve é o destinatário, não
+  // a transmissão, então ele não deve contar para a contrapressão de envio.
+  // Com o pool esgotado a mensagem é descartada, como na recepção.
+  int sendLocal(Port &from, Port &to, Control &ctrl, void *data = nullptr,
+                unsigned int size = 0) {
+    Buffer *buf = _smnic.alloc(0);
     if (buf == nullptr)
       return -1;
     fillLitePacket(buf, from, to, ctrl, data, size);
-    return _smnic.send(buf);
+    int bytes = buf->size();
+    buf->set_receive_time(_sync_engine.getTimestamp());
+    _smnic.countLoopback(bytes);
+    dispatch(_smnic, buf, to);
+    return bytes;
+  }
+
+  // Entrega um quadro já validado às portas de destino: a porta BROADCAST
+  // alcança todos os observadores; as demais, os observadores da porta,
+  // encontrados pelo índice do registro.
+  // Args:
+  //   nic: NIC dona do buffer.
+  //   port: Porta de destino.
+  template <typename NICType>
+  void dispatch(NICType &nic, Buffer *buf, Port port) {
+    if (port == BROADCAST) {
+      // Um único buffer é entregue a todas as portas, com uma referência
+      // por observador; a referência da recepção é solta ao final
+      this->notifyAll(buf, [](Buffer *b) { b->add_ref(); });
+      nic.free(buf);
+    } else if (!this->notify(port, buf)) {
+      nic.countDrop(NICStatistics::DROP_NO_OBSERVER);
+      nic.free(buf);
+    }
   }
 
 protected:
@@ -455,6 +568,9 @@ protected:
   SharedMemNIC _smnic;
   SysID _sysID;
   Navigator _nav;
+  // Último quadrante informado à NIC de sockets
+  std::atomic<int> _quadrant{ -1 };
+  std::mutex _quadrant_mtx;
 };
 
 #endif // PROTOCOL_COMMOM_HH
@@ -40,9 +40,8 @@ public:
 #endif
   }
 
-protected:
   // Construtor: associa o protocolo à NIC e registra-se como observador do
-  // protocolo PROTO
+  // protocolo PROTO. Várias instâncias podem coexistir no processo.
   RSUProtocol(const char *interface_name, SysID sysID, SharedData *shared_data,
               Coord coord, int id, const std::vector<Coordinate> &points,
               Topology topology, double comm_range, double speed = 1)
@@ -50,36 +49,12 @@ protected:
         _crypto_engine(this, shared_data, coord, id) {
   }
 
+protected:
   // Método update: chamado pela NIC quando um frame é recebido.
   // Agora com 3 parâmetros: o Observed, o protocolo e o buffer.
   void update([[maybe_unused]] typename SocketNIC::Observed *obs,
               [[maybe_unused]] typename SocketNIC::Protocol_Number prot,
               Buffer *buf) override {
-    auto handlePacket = [this](auto &nic, Buffer *buf, Port port) {
-      if (port == Base::BROADCAST) {
-        std::vector<Port> allComPorts = Base::Observed::getObservsCond();
-        Buffer *broadcastBuf;
-        for (auto port : allComPorts) {
-          broadcastBuf = nic.alloc(0);
-          if (broadcastBuf == nullptr)
-            continue;
-          if (buf->type() == Buffer::EthernetFrame) {
-            std::memcpy(broadcastBuf->template data<char>(), buf->template data<FullPacket>(), buf->size());
-          } else {
-            std::memcpy(broadcastBuf->template data<char>(), buf->template data<LitePacket>(), buf->size());
-          }
-          broadcastBuf->set_receive_time(buf->get_receive_time());
-          broadcastBuf->setSize(buf->size());
-          if (!this->notify(port, broadcastBuf)) {
-            nic.free(broadcastBuf);
-          }
-        }
-        nic.free(buf);
-      } else if (!this->notify(port, buf)) {
-        nic.free(buf);
-      }
-    };
-
 #ifdef DEBUG_TIMESTAMP_2
     std::cout << get_timestamp() << " I’m RSU " << getpid() << " I received a";
     if (pkt->header()->ctrl.getType() == Control::Type::ANNOUNCE) {
@@ -94,7 +69,7 @@ protected:
       SysID destSysId = pkt->header()->dest.getSysID();
       Port port = pkt->header()->dest.getPort();
       if (destSysId != Base::_sysID && destSysId != Base::UNIVERSAL_BROADCAST && destSysId != Base::EXT_BROADCAST) {
-        Base::_rsnic.free(buf);
+        Base::drop(buf, NICStatistics::DROP_SYSID);
         return;
       }
   
@@ -110,15 +85,19 @@ protected:
         // Se não está sincronizado, enviar mensagens para carro sincronizar
         if (pkt->header()->ctrl.needSync()) {
           Address myaddr = Base::getAddr();
-          Control ctrl(Control::Type::DELAY_RESP);
           int64_t timestamp_relate_to = pkt->header()->timestamp;
-          // Delay Resp
-          Base::send(myaddr, pkt->header()->origin, ctrl, &timestamp_relate_to, 8,
-                     buf->get_receive_time());
-          // Late Sync
-          ctrl.setType(Control::Type::LATE_SYNC);
-          Base::send(myaddr, pkt->header()->origin, ctrl, &timestamp_relate_to,
-                     8);
+          // Late Sync, enviado primeiro para que o instante em que realmente
+          // saiu (t1) siga no Delay Resp
+          Control ctrl(Control::Type::LATE_SYNC);
+          int64_t sync_tx_time = 0;
+          Base::sendSocket(myaddr, pkt->header()->origin, ctrl,
+                           &timestamp_relate_to, 8, 0, &sync_tx_time);
+          // Delay Resp: timestamp de recepção do pedido (t4), seguido do
+          // pedido e do instante de saída do Late Sync
+          ctrl.setType(Control::Type::DELAY_RESP);
+          int64_t delay_resp[2] = { timestamp_relate_to, sync_tx_time };
+          Base::sendSocket(myaddr, pkt->header()->origin, ctrl, delay_resp,
+                           sizeof(delay_resp), buf->get_receive_time());
         }
 #ifdef DEBUG_TIMESTAMP
         else {
@@ -131,11 +110,11 @@ protected:
           return;
         }
       }
-      handlePacket(Base::_rsnic, buf, port);
+      Base::dispatch(Base::_rsnic, buf, port);
     } else {
       LitePacket *lite_pkt = buf->template data<typename Base::SharedMFrame>()->template data<LitePacket>();
       Port port = lite_pkt->header()->dest;
-      handlePacket(Base::_smnic, buf, port);
+      Base::dispatch(Base::_smnic, buf, port);
     }
   }
 
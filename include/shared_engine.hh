@@ -2,25 +2,37 @@
 #define SHARED_ENGINE_HH
 
 #include "buffer.hh"
-#include <cerrno>
+#include "mpmc_queue.hh"
+#include <atomic>
+#include <cstdint>
 #include <cstdio>
-#include <cstring>
+#include <mutex>
 #include <thread>
 
-#include <unordered_map>
-
 #include "ethernet.hh"
 
+// Engine de comunicação dentro do processo (componentes de um mesmo
+// carro). Os remetentes enfileiram os buffers em uma fila sem travas
+// (MpmcQueue) e uma thread despachante os entrega à NIC, como a thread de
+// recepção das Engines de rede: nenhum envio passa por trava ou tabela
+// hash, e cada remetente só paga a inserção na fila.
+//
+// A thread despachante só é criada no primeiro envio: o protocolo entrega
+// as mensagens entre portas do próprio sistema sem passar por aqui (ver
+// ProtocolCommom::sendLocal), e uma NIC sem envios não mantém uma thread
+// ociosa.
 template <typename DataWrapper>
 class SharedEngine {
 public:
   using FrameClass = DataWrapper;
   using Frame = FrameClass::Frame;
-public:
-  // Construtor: Cria e configura o socket raw.
-  SharedEngine(const char *interface_name) : _interface_name(interface_name) {
-    _self = this;
 
+  // Capacidade da fila: comporta todos os buffers de envio de uma NIC
+  static constexpr size_t QUEUE_SIZE = 4096;
+
+public:
+  SharedEngine(const char *interface_name)
+      : _interface_name(interface_name), _queue(QUEUE_SIZE) {
 #ifdef DEBUG
     // Print Debug -------------------------------------------------------
     std::cout << "SharedEngine initialized for interface " << _interface_name
@@ -28,58 +40,63 @@ public:
 #endif
   }
 
-  // Destrutor: Fecha o socket.
+  // Destrutor: encerra a thread despachante.
   ~SharedEngine() {
+    stopReceiving();
 #ifdef DEBUG
     std::cout << "SharedEngine for interface " << _interface_name
               << " destroyed." << std::endl;
 #endif
   }
 
-  // Envia dados usando um buffer pré-preenchido.
+  // Enfileira um buffer pré-preenchido para a thread despachante.
   // Args:
   //   buf: Ponteiro para o Buffer contendo os dados a serem enviados.
   // Returns:
-  //   Número de bytes enviados ou -1 em caso de erro.
+  //   Número de bytes enviados ou -1 se nenhuma NIC estiver associada ou a
+  //   fila estiver cheia.
   int send(Buffer *buf) {
-    int ret = -1;
-    try {
-      std::thread::id thread_id = std::this_thread::get_id();
-      buffer_sem.acquire();
-      unm_buf[thread_id] = buf;
-      buffer_sem.release();
-      ret = buf->size();
-      _self->handler(_self->obj);
-    } catch (const std::exception &e) {
-      ret = -1;
+    if (_handler == nullptr) {
+      return -1;
+    }
+    int size = buf->size();
+    if (!_queue.push(buf)) {
+      return -1;
+    }
+    std::call_once(_started, [this]() {
+      _running.store(true);
+      _dispatcher = std::thread(&SharedEngine::dispatch, this);
+    });
+    // A thread vê o buffer enfileirado ou este remetente vê _idle
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (_idle.load(std::memory_order_relaxed) && _idle.exchange(false)) {
+      _signal.fetch_add(1);
+      _signal.notify_one();
     }
-    return ret;
+    return size;
   }
 
-  // Recebe dados do socket raw.
+  // Retira o próximo buffer da fila. Chamado pela NIC na thread
+  // despachante.
   // Args:
-  //   buf: Referência a um Buffer onde os dados recebidos serão armazenados. O
-  //   buffer deve ser pré-alocado com capacidade suficiente.
+  //   buf: Recebe o buffer enviado.
   // Returns:
-  //   Número de bytes recebidos, 0 se não houver dados (não bloqueante), ou -1
-  //   em caso de erro real.
+  //   Número de bytes recebidos ou -1 se a fila estiver vazia.
   int receive(Buffer *&buf) {
-    int ret = -1;
-    try {
-      std::thread::id thread_id = std::this_thread::get_id();
-      buffer_sem.acquire();
-      if (unm_buf.find(thread_id) != unm_buf.end()) {
-        buf = unm_buf[thread_id];
-        ret = buf->size();
-        unm_buf.erase(thread_id);
-      } else {
-        ret = -1;
-      }
-      buffer_sem.release();
-    } catch (const std::exception &e) {
-      ret = -1;
+    if (!_queue.pop(buf)) {
+      return -1;
+    }
+    return buf->size();
+  }
+
+  // Encerra a thread despachante. Usado por quem precisa parar a entrega
+  // de quadros antes de destruir o próprio estado (ex.: pools da NIC).
+  void stopReceiving() {
+    if (_running.exchange(false)) {
+      _signal.fetch_add(1);
+      _signal.notify_one();
+      _dispatcher.join();
     }
-    return ret;
   }
 
 public:
@@ -87,37 +104,54 @@ public:
     return Ethernet::ZERO;
   }
 
+  // Registra o objeto (NIC) chamado a cada entrega.
   template <typename T, void (T::*handle_signal)()>
-  static void bind(T *obj) {
-    _self->obj = obj;
-    _self->handler = &handlerWrapper<T, handle_signal>;
+  void bind(T *obj) {
+    _obj = obj;
+    _handler = &handlerWrapper<T, handle_signal>;
   }
 
 private:
-  std::binary_semaphore buffer_sem{ 1 };
-  std::unordered_map<std::thread::id, Buffer*> unm_buf;
-
   template <typename T, void (T::*handle_signal)()>
   static void handlerWrapper(void *obj) {
     T *typedObj = static_cast<T *>(obj);
     (typedObj->*handle_signal)();
   }
 
-  int _interface_index;
-  const char *_interface_name;
-
-  static void *obj;
-  static void (*handler)(void *);
-  static SharedEngine *_self;
-};
+  // Thread despachante: a NIC drena a fila a cada chamada do handler; sem
+  // buffers, a thread dorme até que send() a acorde.
+  void dispatch() {
+    for (;;) {
+      if (!_queue.empty()) {
+        _handler(_obj);
+        continue;
+      }
+      if (!_running.load()) {
+        break;
+      }
+      uint32_t seen = _signal.load();
+      _idle.store(true);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (!_queue.empty() || !_running.load()) {
+        _idle.store(false);
+        continue;
+      }
+      _signal.wait(seen);
+    }
+  }
 
-template <typename DataWrapper>
-SharedEngine<DataWrapper> *SharedEngine<DataWrapper>::_self = nullptr;
+  const char *_interface_name;
 
-template <typename DataWrapper>
-void *SharedEngine<DataWrapper>::obj = nullptr;
+  MpmcQueue<Buffer *> _queue;
+  std::once_flag _started; // Despachante criado no primeiro envio
+  std::thread _dispatcher;
+  std::atomic<bool> _running{ false };
+  std::atomic<bool> _idle{ false }; // Despachante dormindo em _signal
+  std::atomic<uint32_t> _signal{ 0 };
 
-template <typename DataWrapper>
-void (*SharedEngine<DataWrapper>::handler)(void *) = nullptr;
+  // Objeto (NIC) e função chamados a cada evento de recepção
+  void *_obj = nullptr;
+  void (*_handler)(void *) = nullptr;
+};
 
 #endif
@@ -0,0 +1,457 @@
+#ifndef SHM_MEDIUM_ENGINE_HH
+#define SHM_MEDIUM_ENGINE_HH
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <initializer_list>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "buffer.hh"
+#include "ethernet.hh"
+
+// Configuração da ShmMediumEngine em tempo de compilação. Para trocar o
+// tamanho do anel, herde desta estrutura e sobrescreva os campos desejados.
+struct DefaultShmMediumConfig {
+  // Quantidade de quadros no anel (potência de 2). Um leitor que fica mais
+  // de SLOTS quadros atrás perde os mais antigos.
+  static constexpr uint64_t SLOTS = 4096;
+  // Quantidade máxima de quadros por chamada de receive_burst
+  static constexpr unsigned int RX_BURST = 32;
+  // Prefixo do nome da região (shm_open); o nome da interface completa
+  static constexpr const char *NAME_PREFIX = "/vcomm_medium_";
+  // Tempo máximo de espera por um slot reservado e não publicado (remetente
+  // que morreu no meio de um envio ou que foi ultrapassado e publicou um
+  // número de sequência antigo). Depois dele, o leitor pula o slot e o conta
+  // como perda. É também o limite de cada espera no futex.
+  static constexpr long WAIT_TIMEOUT_MS = 100;
+};
+
+// Meio de broadcast entre processos do mesmo host em memória compartilhada,
+// com a mesma interface da Engine de socket raw, para uso em
+// NIC<ShmMediumEngine<Ethernet>>. Cada slot carrega o quadro Ethernet
+// inteiro (FullPacket), então os protocolos não mudam.
+//
+// Todos os processos que usam o mesmo nome de interface abrem a mesma
+// região (shm_open, sem root). A região é um anel de SLOTS quadros com
+// vários produtores: cada envio reserva uma posição com um fetch_add e
+// publica o slot com um número de sequência, como um seqlock. Cada leitor
+// (Engine) guarda o próprio cursor e lê o anel sem travas; quem fica uma
+// volta atrás perde quadros, contados em kernelDrops(). Leitores sem dados
+// dormem em um futex compartilhado que os remetentes acordam.
+template <typename DataWrapper, typename Config = DefaultShmMediumConfig>
+class ShmMediumEngine {
+public:
+  using FrameClass = DataWrapper;
+  using Frame = typename FrameClass::Frame;
+
+  static constexpr unsigned int RECEIVE_BURST = Config::RX_BURST;
+  static_assert((Config::SLOTS & (Config::SLOTS - 1)) == 0,
+                "ShmMediumEngine: SLOTS deve ser potência de 2");
+
+private:
+  static constexpr uint64_t MAGIC = 0x766d656469756d31; // "vmedium1"
+  static constexpr size_t FRAME_CAPACITY = 1536;
+
+  // Um quadro no anel. seq vale 2*(pos+1) quando o quadro da posição pos
+  // está publicado e 2*(pos+1)-1 enquanto está sendo escrito.
+  struct alignas(64) Slot {
+    std::atomic<uint64_t> seq;
+    uint64_t sender; // Engine que enviou (não recebe o próprio quadro)
+    uint32_t size;
+    alignas(64) std::byte data[FRAME_CAPACITY];
+  };
+
+  // Cabeçalho da região, seguido dos slots
+  struct Medium {
+    std::atomic<uint64_t> magic;      // MAGIC quando inicializada
+    std::atomic<uint32_t> init;       // 0 livre, 1 inicializando
+    alignas(64) std::atomic<uint64_t> head; // Próxima posição a reservar
+    alignas(64) std::atomic<uint32_t> signal; // Palavra do futex
+    std::atomic<uint32_t> waiters;    // Leitores dormindo no futex
+    alignas(64) Slot slots[Config::SLOTS];
+  };
+
+  static_assert(std::atomic<uint64_t>::is_always_lock_free &&
+                    std::atomic<uint32_t>::is_always_lock_free,
+                "ShmMediumEngine: atômicos precisam ser livres de trava");
+
+public:
+  // Construtor: Abre (ou cria) a região do meio associada à interface e
+  // posiciona o cursor de leitura no fim do anel.
+  ShmMediumEngine(const char *interface_name)
+      : _interface_name(interface_name),
+        _name(std::string(Config::NAME_PREFIX) + interface_name),
+        _id(nextId()) {
+    attachMedium();
+    _cursor = _medium->head.load(std::memory_order_acquire);
+
+    // Endereço localmente administrado: 02:pid(4 bytes):instância
+    unsigned char mac[6] = { 0x02 };
+    uint32_t pid = static_cast<uint32_t>(getpid());
+    std::memcpy(mac + 1, &pid, sizeof(pid));
+    mac[5] = static_cast<unsigned char>(_id);
+    _address = Ethernet::Address(mac);
+#ifdef DEBUG
+    std::cout << "ShmMediumEngine initialized for medium " << _name
+              << std::endl;
+#endif
+  }
+
+  // Destrutor: Para a recepção e desfaz o mapeamento. A região continua
+  // existindo para os demais processos (ver destroyMedium).
+  ~ShmMediumEngine() {
+    stopReceiving();
+    munmap(_medium, sizeof(Medium));
+#ifdef DEBUG
+    std::cout << "ShmMediumEngine for medium " << _name << " destroyed."
+              << std::endl;
+#endif
+  }
+
+  ShmMediumEngine(const ShmMediumEngine &) = delete;
+  ShmMediumEngine &operator=(const ShmMediumEngine &) = delete;
+
+  // Remove o nome da região do meio de uma interface. Processos que já a
+  // mapearam continuam usando-a; os próximos criam uma nova.
+  // Args:
+  //   interface_name: Nome de interface usado pelas Engines.
+  static void destroyMedium(const char *interface_name) {
+    std::string name = std::string(Config::NAME_PREFIX) + interface_name;
+    shm_unlink(name.c_str());
+  }
+
+  // Publica o quadro no anel para todas as Engines do meio.
+  // Args:
+  //   buf: Ponteiro para o Buffer contendo o quadro a ser enviado.
+  // Returns:
+  //   Número de bytes enviados ou -1 em caso de erro.
+  int send(Buffer *buf) {
+    if (!buf || static_cast<size_t>(buf->size()) > FRAME_CAPACITY)
+      return -1;
+
+    uint64_t pos = _medium->head.fetch_add(1, std::memory_order_acq_rel);
+    Slot &slot = _medium->slots[pos & MASK];
+    slot.seq.store(2 * (pos + 1) - 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.sender = _id;
+    slot.size = buf->size();
+    std::memcpy(slot.data, buf->template data<std::byte>(), buf->size());
+    slot.seq.store(2 * (pos + 1), std::memory_order_release);
+
+    // O leitor vê o slot publicado ou este remetente vê o leitor em waiters
+    _medium->signal.fetch_add(1, std::memory_order_seq_cst);
+    if (_medium->waiters.load(std::memory_order_seq_cst) > 0) {
+      futex(&_medium->signal, FUTEX_WAKE, INT_MAX, nullptr);
+    }
+    return buf->size();
+  }
+
+  // Recebe um quadro do anel.
+  // Args:
+  //   buf: Buffer pré-alocado onde o quadro será copiado.
+  // Returns:
+  //   Número de bytes recebidos ou 0 se não houver dados.
+  int receive(Buffer *buf) {
+    int received = receive_burst(&buf, 1);
+    if (received <= 0) {
+      buf->setSize(0);
+      return 0;
+    }
+    return buf->size();
+  }
+
+  // Copia para os buffers os próximos quadros publicados depois do cursor,
+  // pulando os próprios e os recusados pelo filtro de SysID.
+  // Args:
+  //   bufs: Vetor de buffers pré-alocados que receberão os quadros.
+  //   n: Quantidade de buffers no vetor.
+  // Returns:
+  //   Quantidade de quadros recebidos (os primeiros do vetor).
+  int receive_burst(Buffer **bufs, int n) {
+    int received = 0;
+    while (received < n) {
+      uint64_t head = _medium->head.load(std::memory_order_acquire);
+      if (_cursor >= head) {
+        break;
+      }
+      // Mais de uma volta atrás: os quadros mais antigos já foram
+      // sobrescritos
+      if (head - _cursor > Config::SLOTS) {
+        _overruns.fetch_add(head - _cursor - Config::SLOTS,
+                            std::memory_order_relaxed);
+        _cursor = head - Config::SLOTS;
+      }
+      Slot &slot = _medium->slots[_cursor & MASK];
+      const uint64_t published = 2 * (_cursor + 1);
+      uint64_t seq = slot.seq.load(std::memory_order_acquire);
+      if (seq < published) {
+        // Reservado, mas ainda sendo escrito: espera pelo remetente até
+        // WAIT_TIMEOUT_MS e então desiste do slot
+        if (!stalled()) {
+          break;
+        }
+        _overruns.fetch_add(1, std::memory_order_relaxed);
+        _cursor++;
+        continue;
+      }
+      if (seq == published && slot.sender != _id && accept(slot)) {
+        Buffer *buf = bufs[received];
+        unsigned int size = slot.size;
+        if (size > static_cast<unsigned int>(buf->maxSize())) {
+          size = buf->maxSize();
+        }
+        std::memcpy(buf->template data<std::byte>(), slot.data, size);
+        buf->setSize(size);
+        // O quadro pode ter sido sobrescrito durante a cópia
+        std::atomic_thread_fence(std::memory_order_acquire);
+        seq = slot.seq.load(std::memory_order_relaxed);
+        if (seq == published) {
+          received++;
+        }
+      }
+      if (seq != published) {
+        _overruns.fetch_add(1, std::memory_order_relaxed);
+      }
+      _cursor++;
+    }
+    return received;
+  }
+
+  // Descarta, antes da cópia, os quadros originados pelo próprio sistema e
+  // os destinados a outros sistemas. Mesma semântica de
+  // Engine::filterSysID, aplicada pelo leitor em vez do kernel.
+  // A thread de recepção já está rodando (ver bind): o filtro é montado à
+  // parte e publicado por um ponteiro atômico, e os anteriores só são
+  // liberados com a Engine. Não deve ser chamado por duas threads ao mesmo
+  // tempo.
+  void filterSysID(unsigned int origin_offset, unsigned int dest_offset,
+                   int32_t own, std::initializer_list<int32_t> accepted) {
+    auto filter = std::make_unique<const SysIDFilter>(
+        SysIDFilter{ origin_offset, dest_offset, own,
+                     std::vector<int32_t>(accepted.begin(), accepted.end()) });
+    _filter.store(filter.get(), std::memory_order_release);
+    _filters.push_back(std::move(filter));
+  }
+
+  // Quadros perdidos por este leitor desde a última chamada, por ter ficado
+  // uma volta atrás no anel.
+  unsigned long long kernelDrops() {
+    return _overruns.exchange(0, std::memory_order_relaxed);
+  }
+
+  const Ethernet::Address &getAddress() {
+    return _address;
+  }
+
+  // Encerra a thread de recepção. Usado por quem precisa parar a entrega
+  // de quadros antes de destruir o próprio estado (ex.: pools da NIC).
+  void stopReceiving() {
+    if (_running.exchange(false)) {
+      _medium->signal.fetch_add(1, std::memory_order_seq_cst);
+      futex(&_medium->signal, FUTEX_WAKE, INT_MAX, nullptr);
+      _recv_thread.join();
+    }
+  }
+
+  // Registra o objeto (NIC) chamado quando há quadros e inicia a thread de
+  // recepção.
+  template <typename T, void (T::*handle_signal)()>
+  void bind(T *obj) {
+    _obj = obj;
+    _handler = &handlerWrapper<T, handle_signal>;
+    if (!_running.exchange(true)) {
+      _recv_thread = std::thread(&ShmMediumEngine::recvLoop, this);
+    }
+  }
+
+private:
+  static constexpr uint64_t MASK = Config::SLOTS - 1;
+
+  // Identificador único da Engine entre os processos do host
+  static uint64_t nextId() {
+    static std::atomic<uint32_t> next_instance{ 0 };
+    return (static_cast<uint64_t>(getpid()) << 32) | next_instance++;
+  }
+
+  static long futex(std::atomic<uint32_t> *word, int op, uint32_t val,
+                    const struct timespec *timeout) {
+    // Sem FUTEX_PRIVATE_FLAG: a palavra é compartilhada entre processos
+    return syscall(SYS_futex, reinterpret_cast<uint32_t *>(word), op, val,
+                   timeout, nullptr, 0);
+  }
+
+  // Abre ou cria a região e espera que ela esteja inicializada. Quem
+  // ganha a disputa por init zera os contadores e publica MAGIC.
+  void attachMedium() {
+    int fd = shm_open(_name.c_str(), O_RDWR | O_CREAT, 0600);
+    if (fd < 0) {
+      perror("ShmMediumEngine shm_open");
+      exit(EXIT_FAILURE);
+    }
+    struct stat st;
+    if (fstat(fd, &st) < 0) {
+      perror("ShmMediumEngine fstat");
+      exit(EXIT_FAILURE);
+    }
+    // O arquivo recém-estendido vem zerado
+    if (static_cast<size_t>(st.st_size) < sizeof(Medium) &&
+        ftruncate(fd, sizeof(Medium)) < 0) {
+      perror("ShmMediumEngine ftruncate");
+      exit(EXIT_FAILURE);
+    }
+    void *addr = mmap(nullptr, sizeof(Medium), PROT_READ | PROT_WRITE,
+                      MAP_SHARED, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED) {
+      perror("ShmMediumEngine mmap");
+      exit(EXIT_FAILURE);
+    }
+    _medium = static_cast<Medium *>(addr);
+
+    uint32_t expected = 0;
+    if (_medium->magic.load(std::memory_order_acquire) != MAGIC &&
+        _medium->init.compare_exchange_strong(expected, 1)) {
+      _medium->head.store(0, std::memory_order_relaxed);
+      _medium->signal.store(0, std::memory_order_relaxed);
+      _medium->waiters.store(0, std::memory_order_relaxed);
+      _medium->magic.store(MAGIC, std::memory_order_release);
+    }
+    while (_medium->magic.load(std::memory_order_acquire) != MAGIC) {
+      std::this_thread::yield();
+    }
+  }
+
+  // Aplica o filtro de SysID configurado ao quadro do slot.
+  // Returns:
+  //   true se o quadro deve ser entregue.
+  bool accept(const Slot &slot) const {
+    const SysIDFilter *filter = _filter.load(std::memory_order_acquire);
+    if (filter == nullptr) {
+      return true;
+    }
+    if (slot.size < filter->origin_offset + sizeof(int32_t) ||
+        slot.size < filter->dest_offset + sizeof(int32_t)) {
+      return false;
+    }
+    int32_t origin, dest;
+    std::memcpy(&origin, slot.data + filter->origin_offset, sizeof(origin));
+    std::memcpy(&dest, slot.data + filter->dest_offset, sizeof(dest));
+    if (origin == filter->own) {
+      return false;
+    }
+    if (dest == filter->own) {
+      return true;
+    }
+    for (int32_t id : filter->accepted) {
+      if (dest == id) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // O slot do cursor está reservado e sem publicação há WAIT_TIMEOUT_MS?
+  // Marca o início da espera na primeira vez que vê o cursor parado.
+  bool stalled() {
+    auto now = std::chrono::steady_clock::now();
+    if (_stall_cursor != _cursor) {
+      _stall_cursor = _cursor;
+      _stall_since = now;
+      return false;
+    }
+    return now - _stall_since >=
+           std::chrono::milliseconds(Config::WAIT_TIMEOUT_MS);
+  }
+
+  // Há um quadro publicado (ou perdido) na posição do cursor? Um slot que
+  // não foi publicado a tempo conta como perdido (ver stalled).
+  bool pending() {
+    uint64_t head = _medium->head.load(std::memory_order_seq_cst);
+    if (_cursor >= head) {
+      return false;
+    }
+    if (head - _cursor > Config::SLOTS) {
+      return true;
+    }
+    uint64_t seq =
+        _medium->slots[_cursor & MASK].seq.load(std::memory_order_seq_cst);
+    return seq >= 2 * (_cursor + 1) || stalled();
+  }
+
+  // Thread de recepção: a NIC drena o anel a cada chamada do handler; sem
+  // quadros, a thread dorme no futex até que send() a acorde.
+  void recvLoop() {
+    const struct timespec timeout = { 0, Config::WAIT_TIMEOUT_MS * 1000000 };
+    for (;;) {
+      if (pending()) {
+        _handler(_obj);
+        continue;
+      }
+      if (!_running.load()) {
+        break;
+      }
+      uint32_t seen = _medium->signal.load(std::memory_order_seq_cst);
+      _medium->waiters.fetch_add(1, std::memory_order_seq_cst);
+      if (!pending() && _running.load()) {
+        futex(&_medium->signal, FUTEX_WAIT, seen, &timeout);
+      }
+      _medium->waiters.fetch_sub(1, std::memory_order_seq_cst);
+    }
+  }
+
+  template <typename T, void (T::*handle_signal)()>
+  static void handlerWrapper(void *obj) {
+    T *typedObj = static_cast<T *>(obj);
+    (typedObj->*handle_signal)();
+  }
+
+  const char *_interface_name;
+  std::string _name;
+  const uint64_t _id;
+  Ethernet::Address _address;
+
+  Medium *_medium = nullptr;
+  uint64_t _cursor = 0;                     // Próxima posição a ler
+  std::atomic<unsigned long long> _overruns{ 0 };
+
+  // Espera pelo slot do cursor (ver stalled)
+  uint64_t _stall_cursor = UINT64_MAX;
+  std::chrono::steady_clock::time_point _stall_since;
+
+  // Filtro de SysID imutável (ver filterSysID)
+  struct SysIDFilter {
+    unsigned int origin_offset;
+    unsigned int dest_offset;
+    int32_t own;
+    std::vector<int32_t> accepted;
+  };
+  std::atomic<const SysIDFilter *> _filter{ nullptr };
+  std::vector<std::unique_ptr<const SysIDFilter>> _filters; // Publicados
+
+  // Objeto (NIC) e função chamados quando há quadros
+  void *_obj = nullptr;
+  void (*_handler)(void *) = nullptr;
+
+  std::thread _recv_thread;
+  std::atomic<bool> _running{ false };
+};
+
+#endif
@@ -18,6 +18,7 @@
 #include <map>
 #include <numeric>
 #include <semaphore>
+#include <span>
 #include <thread>
 #include <vector>
 
@@ -79,6 +80,12 @@ public:
   }
 
 protected:
+  // Buffer descartado com a fila cheia: volta ao pool
+  void discard(typename Communicator::CommObserver::Observed_Data *buf)
+      override {
+    _communicator->free(buf);
+  }
+
   Communicator *_communicator;
 };
 
@@ -383,6 +390,14 @@ public:
     return Base::_communicator->unmarshal(msg, buf);
   }
 
+  // Recebe de uma vez todas as publicações já enfileiradas, até o tamanho
+  // de msgs, bloqueando apenas até a primeira.
+  // Returns:
+  //   Quantidade de mensagens preenchidas (as primeiras de msgs).
+  size_t receive_batch(std::span<Message *> msgs) {
+    return Base::_communicator->unmarshal_batch(*this, msgs);
+  }
+
   void update(typename Communicator::CommObserver::Observing_Condition c,
               typename Communicator::CommObserver::Observed_Data *buf) {
 #ifdef DEBUG_SMD
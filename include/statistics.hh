@@ -0,0 +1,117 @@
+#ifndef STATISTICS_HH
+#define STATISTICS_HH
+
+#include <array>
+#include <atomic>
+#include <sched.h>
+
+// Estatísticas de rede de uma NIC: quadros e bytes transmitidos e recebidos
+// e descartes por motivo.
+//
+// Os contadores são divididos em fatias por CPU, cada uma em suas próprias
+// linhas de cache, de modo que a thread de recepção e as threads que enviam
+// não disputam as mesmas linhas. Incrementos são atômicos e relaxados; uma
+// leitura (snapshot) soma as fatias.
+class NICStatistics {
+public:
+  enum Counter : unsigned int {
+    TX_PACKETS,
+    TX_BYTES,
+    RX_PACKETS,
+    RX_BYTES,
+    // Pool de buffers esgotado
+    DROP_POOL_EXHAUSTED,
+    // Envio de massa recusado pela contrapressão
+    DROP_BACKPRESSURE,
+    // Falha da Engine ao enviar um quadro da fila de transmissão
+    DROP_TX_FAILED,
+    // Nenhum observador para o protocolo ou porta
+    DROP_NO_OBSERVER,
+    // SysID de destino de outro sistema
+    DROP_SYSID,
+    // Remetente fora do alcance de comunicação
+    DROP_OUT_OF_RANGE,
+    // Mensagem de RSU de outro quadrante
+    DROP_QUADRANT,
+    // Tag MAC inválida
+    DROP_MAC,
+    // Descartados pelo kernel (ex.: socket cheio, PACKET_STATISTICS)
+    DROP_KERNEL,
+    COUNTERS
+  };
+
+  // Quantidade de fatias (CPUs com fatia própria; as demais compartilham)
+  static constexpr unsigned int SHARDS = 16;
+
+  // Cópia dos contadores em um instante.
+  struct Snapshot {
+    std::array<unsigned long long, COUNTERS> counters{};
+
+    unsigned long long operator[](Counter c) const {
+      return counters[c];
+    }
+
+    // Total de quadros descartados, por qualquer motivo
+    unsigned long long drops() const {
+      unsigned long long total = 0;
+      for (unsigned int c = DROP_POOL_EXHAUSTED; c < COUNTERS; c++) {
+        total += counters[c];
+      }
+      return total;
+    }
+  };
+
+  // Soma n ao contador c na fatia da CPU atual.
+  void add(Counter c, unsigned long long n = 1) {
+    shard().counters[c].fetch_add(n, std::memory_order_relaxed);
+  }
+
+  // Registra um quadro e seus bytes (TX_PACKETS/TX_BYTES ou
+  // RX_PACKETS/RX_BYTES).
+  void addFrame(Counter packets, unsigned long long bytes) {
+    Shard &s = shard();
+    s.counters[packets].fetch_add(1, std::memory_order_relaxed);
+    s.counters[packets + 1].fetch_add(bytes, std::memory_order_relaxed);
+  }
+
+  // Lê todos os contadores. Como eles só crescem, duas leituras seguidas
+  // iguais mostram valores que existiram juntos; com escritas contínuas,
+  // desiste após algumas tentativas e retorna a última leitura.
+  Snapshot snapshot() const {
+    Snapshot last = collect();
+    for (int attempt = 0; attempt < SNAPSHOT_ATTEMPTS; attempt++) {
+      Snapshot current = collect();
+      if (current.counters == last.counters) {
+        break;
+      }
+      last = current;
+    }
+    return last;
+  }
+
+private:
+  static constexpr int SNAPSHOT_ATTEMPTS = 4;
+
+  struct alignas(64) Shard {
+    std::array<std::atomic<unsigned long long>, COUNTERS> counters{};
+  };
+
+  Shard &shard() {
+    int cpu = sched_getcpu();
+    return _shards[cpu > 0 ? static_cast<unsigned int>(cpu) % SHARDS : 0];
+  }
+
+  Snapshot collect() const {
+    Snapshot snap;
+    for (const Shard &s : _shards) {
+      for (unsigned int c = 0; c < COUNTERS; c++) {
+        snap.counters[c] += s.counters[c].load(std::memory_order_relaxed);
+      }
+    }
+    return snap;
+  }
+
+  std::array<Shard, SHARDS> _shards;
+};
+
+#endif
@@ -8,6 +8,7 @@
 #include <chrono>
 #include <condition_variable>
 #include <iostream>
+#include <limits>
 #include <mutex>
 #include <set>
 #include <sys/types.h>
@@ -34,38 +35,62 @@ public:
     return offset;
   }
 #ifndef SIMULATION_TIMESTAMP
-  // Retorna tempo atual com offset aplicado
-  std::chrono::time_point<std::chrono::system_clock> now() const {
+  // Converte um instante do relógio do sistema (ex.: timestamp registrado
+  // pelo kernel) para este relógio, aplicando o offset
+  std::chrono::time_point<std::chrono::system_clock>
+  convert(std::chrono::time_point<std::chrono::system_clock> system) const {
 #ifndef TURN_PTP_OFF
-    return std::chrono::system_clock::now() - std::chrono::microseconds(offset);
+    return system - std::chrono::microseconds(offset);
 #else
-    return std::chrono::system_clock::now();
+    return system;
 #endif
   }
 #else
-  // Retorna tempo atual com offset aplicado
-  std::chrono::time_point<std::chrono::system_clock> now() const {
+  // Converte um instante do relógio do sistema (ex.: timestamp registrado
+  // pelo kernel) para este relógio, aplicando o offset
+  std::chrono::time_point<std::chrono::system_clock>
+  convert(std::chrono::time_point<std::chrono::system_clock> system) const {
     GlobalTime &g = GlobalTime::getInstance();
     static int64_t simulation_offset = g.get_program_init() - SIMULATION_TIMESTAMP;
-    auto now = std::chrono::system_clock::now();
 
 #ifndef TURN_PTP_OFF
     // Retorna o tempo simulado ajustado pelo offset
     return std::chrono::time_point<std::chrono::system_clock>(
-      now.time_since_epoch() - std::chrono::microseconds(simulation_offset - offset));
+      system.time_since_epoch() - std::chrono::microseconds(simulation_offset - offset));
 #else
     // Retorna o tempo simulado ajustado pelo offset
     return std::chrono::time_point<std::chrono::system_clock>(
-      now.time_since_epoch() - std::chrono::microseconds(simulation_offset));
+      system.time_since_epoch() - std::chrono::microseconds(simulation_offset));
 #endif
   }
 #endif
+
+  // Retorna tempo atual com offset aplicado
+  std::chrono::time_point<std::chrono::system_clock> now() const {
+    return convert(std::chrono::system_clock::now());
+  }
+
   int64_t getTimestamp() const {
     return std::chrono::duration_cast<std::chrono::microseconds>(
                now().time_since_epoch())
         .count();
   }
 
+  // Converte um timestamp do relógio do sistema (us desde a época) para
+  // este relógio.
+  // Args:
+  //   system_us: Instante no relógio do sistema, em microssegundos.
+  // Returns:
+  //   O mesmo instante neste relógio, em microssegundos.
+  int64_t getTimestamp(int64_t system_us) const {
+    std::chrono::time_point<std::chrono::system_clock> system{
+      std::chrono::microseconds(system_us)
+    };
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               convert(system).time_since_epoch())
+        .count();
+  }
+
 private:
   int64_t offset{};
 };
@@ -89,12 +114,23 @@ public:
         _announce_thread_running(false), _clock(0), _synced(false),
         _needSync(true), _announce_iteration(0), _broadcast_already_sent(false),
         _isRSU(isRSU) {
-    if (!_isRSU) {
+  }
+
+  ~SyncEngine() {
+    stop();
+  }
+
+  // Inicia a thread de anúncios. Chamado pelo protocolo depois que suas NICs
+  // estão construídas, pois a thread envia por elas.
+  void start() {
+    if (!_isRSU && !_announce_thread_running) {
       startAnnounceThread();
     }
   }
 
-  ~SyncEngine() {
+  // Para a thread de anúncios. Chamado pelo protocolo antes de destruir suas
+  // NICs.
+  void stop() {
     if (!_isRSU) {
       stopAnnounceThread();
     }
@@ -105,53 +141,84 @@ public:
   // return: int.
   // 0: announce ou delay, não fazer nada.
   // 1: sync ou delay_req, responder
+  // sync_tx_time: instante de saída do Late Sync, informado pela RSU no
+  // Delay Resp (0 se ausente).
   void handlePTP(int64_t recv_timestamp, int64_t msg_timestamp,
                  Address origin_addr, Control::Type type,
-                 int64_t timestamp_related_to) {
+                 int64_t timestamp_related_to, int64_t sync_tx_time = 0) {
+    // Respostas de RSUs diferentes podem chegar por filas de recepção
+    // diferentes
+    std::lock_guard<std::mutex> lock(_ptp_mtx);
+    if (type != DELAY_RESP && type != LATE_SYNC) {
+      return;
+    }
+    // Respostas a um pedido já usado (ex.: de outra RSU) não ajustam o
+    // relógio de novo
+    if (timestamp_related_to <= _last_request) {
+      return;
+    }
+    if (_exchanges.size() >= MAX_PENDING &&
+        _exchanges.find(timestamp_related_to) == _exchanges.end()) {
+      _exchanges.clear();
+    }
+    // Delay Resp e Late Sync da mesma requisição podem chegar em qualquer
+    // ordem
+    Exchange &exchange = _exchanges[timestamp_related_to];
     if (type == DELAY_RESP) {            // delay_resp
       if (origin_addr != _master_addr) { // delay_resp de uma RSU diferente
-        // Anota delay_req_t e delay_resp_t
-        _map_delay_req_delay_resp_t[timestamp_related_to] = msg_timestamp;
         // Reset State Machine
         _master_addr = origin_addr;
-      } else {
-        // Anota delay_req_t e delay_resp_t
-        _map_delay_req_delay_resp_t[timestamp_related_to] = msg_timestamp;
       }
-    } else if (type == LATE_SYNC) { // Late Sync
-      // Caso eu não tenha recebido Delay_Resp antes de ter recebido o late
-      // sync, retorna
-      if (_map_delay_req_delay_resp_t.find(timestamp_related_to) ==
-          _map_delay_req_delay_resp_t.end()) {
-        return;
+      // Anota delay_resp_t
+      exchange.t4 = msg_timestamp;
+      // Instante em que o Late Sync realmente saiu da RSU
+      if (sync_tx_time != 0) {
+        exchange.t1 = sync_tx_time;
+      }
+      exchange.has_resp = true;
+    } else { // Late Sync
+      exchange.t2 = recv_timestamp;
+      // Sem o instante de saída, usa o do cabeçalho
+      if (exchange.t1 == 0) {
+        exchange.t1 = msg_timestamp;
       }
+      exchange.has_sync = true;
+    }
+    updateOffset(timestamp_related_to);
+  }
 
-      // Tempo que lider enviou o Late Sync
-      int64_t t1 = msg_timestamp;
-      // Tempo que slave recebeu Late Sync
-      int64_t t2 = recv_timestamp;
-      // Tempo em que slave requisitou Delay
-      int64_t t3 = timestamp_related_to;
-      // Tempo em que Lider recebeu a requisiçao do Delay
-      int64_t t4 = _map_delay_req_delay_resp_t[timestamp_related_to];
-
-      // Calcula novo offset.
-      int64_t delay = ((t4 - t3) + (t2 - t1)) / 2;
-      int64_t offset = (t2 - t1) - delay;
-
-      _clock.setOffset(offset);
-      _synced = true;
-      _needSync = false;
-      _announc_it_mtx.lock();
-      _announce_iteration = 0;
-      _announc_it_mtx.unlock();
-      _map_delay_req_delay_resp_t.clear();
-#ifdef DEBUG_TIMESTAMP
-      std::cout << get_timestamp() << " I’m Car " << getpid()
-                << " My offset is " << getClockOffset() << std::endl;
-#endif
+  // Indica se o instante de saída das mensagens deve ser medido: enquanto
+  // um veículo precisa sincronizar, cada mensagem serve de Delay Req.
+  bool measuresDelayReq() const {
+    return !_isRSU && _needSync;
+  }
+
+  // Registra, antes do envio, uma mensagem que serve de Delay Req: as
+  // respostas a ela esperam pelo seu instante de saída.
+  // Args:
+  //   msg_timestamp: Timestamp no cabeçalho da mensagem (ecoado pela RSU).
+  void beginDelayReq(int64_t msg_timestamp) {
+    std::lock_guard<std::mutex> lock(_ptp_mtx);
+    if (_delay_req_tx.size() >= MAX_PENDING) {
+      _delay_req_tx.clear();
     }
-    return;
+    _delay_req_tx[msg_timestamp] = TX_PENDING;
+  }
+
+  // Anota o instante em que um Delay Req registrado saiu pela rede, usado
+  // no lugar do timestamp do cabeçalho.
+  // Args:
+  //   msg_timestamp: Timestamp no cabeçalho da mensagem (ecoado pela RSU).
+  //   tx_time: Instante de transmissão, ou 0 se desconhecido.
+  void setDelayReqTxTime(int64_t msg_timestamp, int64_t tx_time) {
+    std::lock_guard<std::mutex> lock(_ptp_mtx);
+    auto sent = _delay_req_tx.find(msg_timestamp);
+    if (sent == _delay_req_tx.end()) {
+      return;
+    }
+    sent->second = tx_time != 0 ? tx_time : msg_timestamp;
+    // As respostas podem ter chegado antes
+    updateOffset(msg_timestamp);
   }
 
   int64_t getTimestamp() const {
@@ -179,6 +246,51 @@ public:
   }
 
 private:
+  // Calcula o novo offset se a troca do pedido estiver completa: Late Sync,
+  // Delay Resp e instante de saída do pedido. Chamado com _ptp_mtx travado.
+  // Args:
+  //   timestamp_related_to: Timestamp do pedido (Delay Req).
+  void updateOffset(int64_t timestamp_related_to) {
+    auto found = _exchanges.find(timestamp_related_to);
+    if (found == _exchanges.end() || !found->second.has_resp ||
+        !found->second.has_sync) {
+      return;
+    }
+    auto sent = _delay_req_tx.find(timestamp_related_to);
+    if (sent != _delay_req_tx.end() && sent->second == TX_PENDING) {
+      return;
+    }
+    Exchange &exchange = found->second;
+
+    // Tempo que lider enviou o Late Sync
+    int64_t t1 = exchange.t1;
+    // Tempo que slave recebeu Late Sync
+    int64_t t2 = exchange.t2;
+    // Tempo em que slave requisitou Delay (instante de saída, se conhecido)
+    int64_t t3 =
+        sent != _delay_req_tx.end() ? sent->second : timestamp_related_to;
+    // Tempo em que Lider recebeu a requisiçao do Delay
+    int64_t t4 = exchange.t4;
+
+    // Calcula novo offset.
+    int64_t delay = ((t4 - t3) + (t2 - t1)) / 2;
+    int64_t offset = (t2 - t1) - delay;
+
+    _clock.setOffset(offset);
+    _synced = true;
+    _needSync = false;
+    _announc_it_mtx.lock();
+    _announce_iteration = 0;
+    _announc_it_mtx.unlock();
+    _last_request = timestamp_related_to;
+    _exchanges.clear();
+    _delay_req_tx.clear();
+#ifdef DEBUG_TIMESTAMP
+    std::cout << get_timestamp() << " I’m Car " << getpid()
+              << " My offset is " << getClockOffset() << std::endl;
+#endif
+  }
+
   void startAnnounceThread() {
 #ifdef DEBUG_SYNC
     std::cout << get_timestamp() << " Announce thread started " << getpid()
@@ -245,8 +357,25 @@ private:
   std::atomic<bool> _announce_thread_running = false;
 
   // PTP ------------------------------------------
-  // Map que relaciona tempos de delay_req(chave) e tempos de delay_resp(valor)
-  std::unordered_map<int64_t, int64_t> _map_delay_req_delay_resp_t;
+  // Tempos de uma troca PTP, identificada pelo timestamp do delay_req
+  struct Exchange {
+    int64_t t1 = 0;
+    int64_t t2 = 0;
+    int64_t t4 = 0;
+    bool has_sync = false;
+    bool has_resp = false;
+  };
+  // Limite de trocas e de delay_reqs pendentes antes de descartá-los
+  static constexpr size_t MAX_PENDING = 64;
+  // Delay_req enviado cujo instante de saída ainda não é conhecido
+  static constexpr int64_t TX_PENDING = -1;
+  // Map que relaciona tempos de delay_req(chave) e a troca correspondente
+  std::unordered_map<int64_t, Exchange> _exchanges;
+  // Map que relaciona tempos de delay_req(chave) e seu instante de saída
+  std::unordered_map<int64_t, int64_t> _delay_req_tx;
+  // Último delay_req usado para ajustar o relógio
+  int64_t _last_request = std::numeric_limits<int64_t>::min();
+  std::mutex _ptp_mtx;
 
   Address _master_addr;
   SimulatedClock _clock;
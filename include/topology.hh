@@ -3,6 +3,7 @@
 
 #include <cmath>
 #include <utility>
+#include <vector>
 
 class Topology {
 public:
@@ -39,6 +40,28 @@ public:
     return x_int + y_int * _size.first;
   }
 
+  // Retorna o quadrante e seus vizinhos (até 8) dentro da grade.
+  // Args:
+  //   quadrant_id: Quadrante central, como em get_quadrant_id.
+  // Returns:
+  //   IDs dos quadrantes, começando pelo próprio.
+  std::vector<int> get_neighborhood(int quadrant_id) const {
+    std::vector<int> ids = { quadrant_id };
+    int col = quadrant_id % _size.first;
+    int row = quadrant_id / _size.first;
+    for (int dy = -1; dy <= 1; dy++) {
+      for (int dx = -1; dx <= 1; dx++) {
+        int x = col + dx;
+        int y = row + dy;
+        if ((dx != 0 || dy != 0) && x >= 0 && x < _size.first && y >= 0 &&
+            y < _size.second) {
+          ids.push_back(x + y * _size.first);
+        }
+      }
+    }
+    return ids;
+  }
+
   Size get_size() const {
     return _size;
   }
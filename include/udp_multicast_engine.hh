@@ -0,0 +1,373 @@
+#ifndef UDP_MULTICAST_ENGINE_HH
+#define UDP_MULTICAST_ENGINE_HH
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <initializer_list>
+#include <iostream>
+#include <mutex>
+#include <set>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <linux/errqueue.h>
+#include <linux/filter.h>
+#include <linux/net_tstamp.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <fcntl.h>
+
+#include "buffer.hh"
+#include "engine_helpers.hh"
+#include "ethernet.hh"
+
+// Configuração da UdpMulticastEngine em tempo de compilação. Para trocar a
+// porta ou os grupos, herde desta estrutura e sobrescreva os campos
+// desejados.
+struct DefaultUdpMulticastConfig {
+  // Porta UDP usada por todos os grupos
+  static constexpr uint16_t PORT = 34997;
+  // Grupo do quadrante q: GROUP_BASE + q (239.255.0.0/16, escopo local)
+  static constexpr uint32_t GROUP_BASE = 0xEFFF0000;
+  // TTL dos datagramas: 1 mantém o tráfego no enlace local
+  static constexpr int TTL = 1;
+  // Timestamps de recepção registrados pelo kernel (SO_TIMESTAMPING)
+  static constexpr bool TIMESTAMPING = true;
+};
+
+// Engine sobre UDP multicast, com a mesma interface da Engine de socket raw,
+// para uso em NIC<UdpMulticastEngine<Ethernet>>. Cada datagrama carrega o
+// quadro Ethernet inteiro, então os protocolos não mudam.
+//
+// Cada quadrante da topologia é um grupo multicast. A Engine envia para o
+// grupo do seu quadrante e escuta apenas os grupos informados em
+// setQuadrant (ex.: o próprio quadrante e os vizinhos): o kernel descarta o
+// tráfego dos demais quadrantes. Não precisa de root. Os datagramas voltam
+// para o próprio host (IP_MULTICAST_LOOP), o que permite vários sistemas
+// na mesma máquina, como na Engine de socket raw.
+template <typename DataWrapper, typename Config = DefaultUdpMulticastConfig>
+class UdpMulticastEngine {
+public:
+  using FrameClass = DataWrapper;
+  using Frame = typename FrameClass::Frame;
+
+  // Tamanho da rajada usada pela NIC ao drenar o socket
+  static constexpr unsigned int RECEIVE_BURST = 32;
+  // Espaço de controle para um SCM_TIMESTAMPING por mensagem
+  static constexpr size_t TS_CONTROL_SIZE =
+      CMSG_SPACE(sizeof(struct scm_timestamping));
+
+public:
+  // Construtor: Cria o socket UDP e o associa à interface. Nenhum grupo é
+  // escutado até a primeira chamada de setQuadrant.
+  UdpMulticastEngine(const char *interface_name)
+      : _interface_name(interface_name) {
+    if (!get_interface_info()) {
+      perror("UdpMulticastEngine Error: interface info");
+      exit(EXIT_FAILURE);
+    }
+
+    setupSocket();
+
+    turnRecvOn();
+#ifdef DEBUG
+    std::cout << "UdpMulticastEngine initialized for interface "
+              << _interface_name << " (port " << Config::PORT << ")"
+              << std::endl;
+#endif
+  }
+
+  // Destrutor: Para a recepção e fecha o socket (o kernel sai dos grupos).
+  ~UdpMulticastEngine() {
+    stopReceiving();
+
+    if (_socket != -1) {
+      close(_socket);
+    }
+  }
+
+  // Define o quadrante atual: os envios passam a ir para o seu grupo e
+  // apenas os grupos listados continuam sendo escutados.
+  // Args:
+  //   quadrant: Quadrante em que o sistema está.
+  //   listened: Quadrantes cujos grupos devem ser escutados.
+  void setQuadrant(int quadrant, const std::vector<int> &listened) {
+    std::lock_guard<std::mutex> lock(_groups_mtx);
+    _send_group.store(group(quadrant), std::memory_order_relaxed);
+
+    std::set<int> wanted(listened.begin(), listened.end());
+    for (auto it = _joined.begin(); it != _joined.end();) {
+      if (wanted.count(*it) == 0) {
+        membership(IP_DROP_MEMBERSHIP, *it);
+        it = _joined.erase(it);
+      } else {
+        ++it;
+      }
+    }
+    for (int q : wanted) {
+      if (_joined.count(q) == 0 && membership(IP_ADD_MEMBERSHIP, q)) {
+        _joined.insert(q);
+      }
+    }
+  }
+
+  // Envia o quadro contido no buffer para o grupo do quadrante atual.
+  // Args:
+  //   buf: Ponteiro para o Buffer contendo o quadro a ser enviado.
+  // Returns:
+  //   Número de bytes enviados ou -1 em caso de erro.
+  int send(Buffer *buf) {
+    if (!buf)
+      return -1;
+
+    struct sockaddr_in dest;
+    std::memset(&dest, 0, sizeof(dest));
+    dest.sin_family = AF_INET;
+    dest.sin_port = htons(Config::PORT);
+    dest.sin_addr.s_addr = htonl(_send_group.load(std::memory_order_relaxed));
+    int send_len = sendto(_socket, buf->template data<Frame>(), buf->size(),
+                          0, (const sockaddr *)&dest, sizeof(dest));
+    if (send_len < 0) {
+#ifdef DEBUG
+      perror("UdpMulticastEngine::send sendto error");
+#endif
+      return -1;
+    }
+    return send_len;
+  }
+
+  // Recebe um datagrama (um quadro) do socket.
+  // Args:
+  //   buf: Buffer pré-alocado onde o quadro será armazenado.
+  // Returns:
+  //   Número de bytes recebidos, 0 se não houver dados ou -1 em caso de
+  //   erro.
+  int receive(Buffer *buf) {
+    return receive_burst(&buf, 1);
+  }
+
+  // Recebe uma rajada de datagramas com uma única chamada de sistema
+  // (recvmmsg).
+  // Args:
+  //   bufs: Vetor de buffers pré-alocados que receberão os quadros.
+  //   n: Quantidade de buffers no vetor.
+  // Returns:
+  //   Quantidade de quadros recebidos (os primeiros do vetor), 0 se não houver
+  //   dados ou -1 em caso de erro real.
+  int receive_burst(Buffer **bufs, int n) {
+    struct mmsghdr msgs[RECEIVE_BURST];
+    struct iovec iovs[RECEIVE_BURST];
+    [[maybe_unused]] alignas(struct cmsghdr) char
+        controls[RECEIVE_BURST][TS_CONTROL_SIZE];
+    if (n > (int)RECEIVE_BURST) {
+      n = RECEIVE_BURST;
+    }
+    for (int i = 0; i < n; i++) {
+      iovs[i].iov_base = bufs[i]->template data<Frame>();
+      iovs[i].iov_len = bufs[i]->maxSize();
+      std::memset(&msgs[i], 0, sizeof(msgs[i]));
+      msgs[i].msg_hdr.msg_iov = &iovs[i];
+      msgs[i].msg_hdr.msg_iovlen = 1;
+      if constexpr (Config::TIMESTAMPING) {
+        msgs[i].msg_hdr.msg_control = controls[i];
+        msgs[i].msg_hdr.msg_controllen = TS_CONTROL_SIZE;
+      }
+    }
+
+    int received = recvmmsg(_socket, msgs, n, MSG_DONTWAIT, nullptr);
+    if (received < 0) {
+      if (errno == EWOULDBLOCK || errno == EAGAIN) {
+        bufs[0]->setSize(0);
+        return 0;
+      }
+      perror("UdpMulticastEngine::receive_burst recvmmsg error");
+      return -1;
+    }
+    for (int i = 0; i < received; i++) {
+      bufs[i]->setSize(msgs[i].msg_len);
+      if constexpr (Config::TIMESTAMPING) {
+        bufs[i]->set_kernel_time(kernelTime(&msgs[i].msg_hdr));
+      }
+    }
+    return received;
+  }
+
+  // Substitui o filtro BPF do socket por um que descarta no kernel os
+  // quadros originados pelo próprio sistema (que voltam pelo loop do
+  // multicast) e os destinados a outros sistemas. Mesma semântica de
+  // Engine::filterSysID; os deslocamentos são relativos ao início do quadro.
+  void filterSysID(unsigned int origin_offset, unsigned int dest_offset,
+                   int32_t own, std::initializer_list<int32_t> accepted) {
+    std::vector<struct sock_filter> bpf_code = EngineHelpers::sysIDFilter(
+        FILTER_BASE, 0, origin_offset, dest_offset, own, accepted);
+    EngineHelpers::attachFilter(_socket, bpf_code);
+  }
+
+  const Ethernet::Address &getAddress() {
+    return _address;
+  }
+
+  // Encerra a thread de recepção. Usado por quem precisa parar a entrega
+  // de quadros antes de destruir o próprio estado (ex.: pools da NIC).
+  void stopReceiving() {
+    _recv.stop();
+  }
+
+  template <typename T, void (T::*handle_signal)()>
+  void bind(T *obj) {
+    _obj = obj;
+    _handler = &handlerWrapper<T, handle_signal>;
+    _recv.watch(_socket, "udp socket");
+  }
+
+private:
+  // No filtro de um socket UDP os dados começam no cabeçalho UDP
+  static constexpr unsigned int FILTER_BASE = 8;
+
+  // Endereço (ordem do host) do grupo de um quadrante.
+  static uint32_t group(int quadrant) {
+    return Config::GROUP_BASE + static_cast<uint32_t>(quadrant);
+  }
+
+  // Entra ou sai do grupo de um quadrante na interface da Engine.
+  // Args:
+  //   option: IP_ADD_MEMBERSHIP ou IP_DROP_MEMBERSHIP.
+  //   quadrant: Quadrante do grupo.
+  // Returns:
+  //   true em caso de sucesso.
+  bool membership(int option, int quadrant) {
+    struct ip_mreqn mreq;
+    std::memset(&mreq, 0, sizeof(mreq));
+    mreq.imr_multiaddr.s_addr = htonl(group(quadrant));
+    mreq.imr_ifindex = _interface_index;
+    if (setsockopt(_socket, IPPROTO_IP, option, &mreq, sizeof(mreq)) < 0) {
+      perror(option == IP_ADD_MEMBERSHIP ? "setsockopt IP_ADD_MEMBERSHIP"
+                                         : "setsockopt IP_DROP_MEMBERSHIP");
+      return false;
+    }
+    return true;
+  }
+
+  // Obtém MAC e índice da interface.
+  bool get_interface_info() {
+    _interface_index =
+        EngineHelpers::interfaceInfo(_interface_name, _address);
+    return _interface_index != 0;
+  }
+
+  // Cria o socket UDP não bloqueante, compartilhando a porta com os demais
+  // sistemas do host, e configura o multicast na interface.
+  void setupSocket() {
+    _socket = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (_socket == -1) {
+      perror("socket creation (udp)");
+      exit(EXIT_FAILURE);
+    }
+
+    int one = 1;
+    if (setsockopt(_socket, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one)) <
+        0) {
+      perror("setsockopt SO_REUSEADDR");
+      exit(EXIT_FAILURE);
+    }
+
+    // Sem isso o socket receberia os grupos de qualquer socket do host
+    int zero = 0;
+    if (setsockopt(_socket, IPPROTO_IP, IP_MULTICAST_ALL, &zero,
+                   sizeof(zero)) < 0) {
+      perror("setsockopt IP_MULTICAST_ALL");
+      exit(EXIT_FAILURE);
+    }
+
+    struct ip_mreqn mreq;
+    std::memset(&mreq, 0, sizeof(mreq));
+    mreq.imr_ifindex = _interface_index;
+    if (setsockopt(_socket, IPPROTO_IP, IP_MULTICAST_IF, &mreq,
+                   sizeof(mreq)) < 0) {
+      perror("setsockopt IP_MULTICAST_IF");
+      exit(EXIT_FAILURE);
+    }
+
+    // Entrega também aos sistemas do próprio host
+    if (setsockopt(_socket, IPPROTO_IP, IP_MULTICAST_LOOP, &one,
+                   sizeof(one)) < 0) {
+      perror("setsockopt IP_MULTICAST_LOOP");
+      exit(EXIT_FAILURE);
+    }
+
+    int ttl = Config::TTL;
+    if (setsockopt(_socket, IPPROTO_IP, IP_MULTICAST_TTL, &ttl,
+                   sizeof(ttl)) < 0) {
+      perror("setsockopt IP_MULTICAST_TTL");
+      exit(EXIT_FAILURE);
+    }
+
+    if constexpr (Config::TIMESTAMPING) {
+      int flags = SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE;
+      if (setsockopt(_socket, SOL_SOCKET, SO_TIMESTAMPING, &flags,
+                     sizeof(flags)) < 0) {
+        perror("setsockopt SO_TIMESTAMPING");
+      }
+    }
+
+    // SO_RCVBUFFORCE exigiria CAP_NET_ADMIN
+    int tam = 8 * 1024 * 1024;
+    if (setsockopt(_socket, SOL_SOCKET, SO_RCVBUF, &tam, sizeof(tam)) < 0) {
+      perror("setsockopt SO_RCVBUF");
+    }
+
+    struct sockaddr_in addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(Config::PORT);
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    if (::bind(_socket, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+      perror("bind (udp socket)");
+      exit(EXIT_FAILURE);
+    }
+  }
+
+  // Extrai de uma mensagem recebida o timestamp de software
+  // SCM_TIMESTAMPING.
+  // Returns:
+  //   Instante registrado pelo kernel (us, relógio do sistema) ou 0.
+  static int64_t kernelTime(struct msghdr *msg) {
+    return EngineHelpers::kernelTime(msg, false);
+  }
+
+  // Dispara a thread de recepção, que chama o handler da NIC a cada evento
+  // do socket.
+  void turnRecvOn() {
+    _recv.start([this]() { _handler(_obj); });
+  }
+
+  template <typename T, void (T::*handle_signal)()>
+  static void handlerWrapper(void *obj) {
+    T *typedObj = static_cast<T *>(obj);
+    (typedObj->*handle_signal)();
+  }
+
+  const char *_interface_name;
+  int _interface_index = 0;
+  Ethernet::Address _address;
+
+  int _socket = -1;
+  // Grupo (ordem do host) para onde vão os envios
+  std::atomic<uint32_t> _send_group{ Config::GROUP_BASE };
+  // Quadrantes cujos grupos o socket escuta
+  std::mutex _groups_mtx;
+  std::set<int> _joined;
+
+  // Objeto (NIC) e função chamados a cada evento de recepção
+  void *_obj = nullptr;
+  void (*_handler)(void *) = nullptr;
+
+  // ---- Controle da thread de recepcao ----
+  EngineHelpers::RecvThread _recv;
+};
+
+#endif
@@ -0,0 +1,569 @@
+#ifndef XDP_ENGINE_HH
+#define XDP_ENGINE_HH
+
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <linux/bpf.h>
+#include <linux/if_link.h>
+#include <linux/if_xdp.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "buffer.hh"
+#include "engine_helpers.hh"
+#include "ethernet.hh"
+
+// Configuração da XdpEngine em tempo de compilação. Para trocar a geometria,
+// herde desta estrutura e sobrescreva os campos desejados.
+struct DefaultXdpConfig {
+  // Quadros da UMEM: a primeira metade abastece a recepção e a segunda o
+  // envio
+  static constexpr unsigned int FRAME_COUNT = 4096;
+  static constexpr unsigned int FRAME_SIZE = 2048;
+  // Tamanho dos anéis fill, completion, RX e TX (potência de 2)
+  static constexpr unsigned int RING_SIZE = 2048;
+  // Fila da interface associada ao socket
+  static constexpr unsigned int QUEUE_ID = 0;
+  // EtherType redirecionado pelo programa XDP; o resto segue para o kernel
+  static constexpr uint16_t ETHER_TYPE = 0x88B5;
+};
+
+// Anel produtor/consumidor do AF_XDP compartilhado com o kernel.
+template <typename T>
+class XskRing {
+public:
+  // Mapeia o anel do socket.
+  // Args:
+  //   fd: socket AF_XDP.
+  //   pgoff: deslocamento que identifica o anel (XDP_PGOFF_*).
+  //   off: deslocamentos do anel obtidos com XDP_MMAP_OFFSETS.
+  //   size: quantidade de entradas (potência de 2).
+  // Returns:
+  //   false se o mmap falhar (errno preservado).
+  bool map(int fd, off_t pgoff, const xdp_ring_offset &off, unsigned int size) {
+    _map_size = off.desc + size * sizeof(T);
+    void *map = mmap(nullptr, _map_size, PROT_READ | PROT_WRITE,
+                     MAP_SHARED | MAP_POPULATE, fd, pgoff);
+    if (map == MAP_FAILED) {
+      return false;
+    }
+    _map = static_cast<std::byte *>(map);
+    _producer = reinterpret_cast<uint32_t *>(_map + off.producer);
+    _consumer = reinterpret_cast<uint32_t *>(_map + off.consumer);
+    _ring = reinterpret_cast<T *>(_map + off.desc);
+    _size = size;
+    _mask = size - 1;
+    _local_prod = producer().load(std::memory_order_relaxed);
+    _local_cons = consumer().load(std::memory_order_relaxed);
+    return true;
+  }
+
+  ~XskRing() {
+    unmap();
+  }
+
+  void unmap() {
+    if (_map != nullptr) {
+      munmap(_map, _map_size);
+      _map = nullptr;
+    }
+  }
+
+  // Lado produtor: espaço livre no anel.
+  unsigned int freeSlots() {
+    return _size - (_local_prod - consumer().load(std::memory_order_acquire));
+  }
+
+  // Lado produtor: publica uma entrada. O chamador garante espaço livre.
+  void push(const T &entry) {
+    _ring[_local_prod & _mask] = entry;
+    _local_prod++;
+    producer().store(_local_prod, std::memory_order_release);
+  }
+
+  // Lado consumidor: retira uma entrada, se houver.
+  bool pop(T &entry) {
+    if (_local_cons == producer().load(std::memory_order_acquire)) {
+      return false;
+    }
+    entry = _ring[_local_cons & _mask];
+    _local_cons++;
+    consumer().store(_local_cons, std::memory_order_release);
+    return true;
+  }
+
+  // Lado consumidor: indica se há entradas, sem retirá-las.
+  bool pending() {
+    return _local_cons != producer().load(std::memory_order_acquire);
+  }
+
+private:
+  std::atomic_ref<uint32_t> producer() {
+    return std::atomic_ref<uint32_t>(*_producer);
+  }
+
+  std::atomic_ref<uint32_t> consumer() {
+    return std::atomic_ref<uint32_t>(*_consumer);
+  }
+
+  std::byte *_map = nullptr;
+  size_t _map_size = 0;
+  uint32_t *_producer = nullptr;
+  uint32_t *_consumer = nullptr;
+  T *_ring = nullptr;
+  unsigned int _size = 0;
+  unsigned int _mask = 0;
+  uint32_t _local_prod = 0;
+  uint32_t _local_cons = 0;
+};
+
+// Engine sobre AF_XDP, com a mesma interface da Engine de socket raw, para
+// uso em NIC<XdpEngine<Ethernet>>. Os quadros recebidos e enviados ficam na
+// UMEM e são entregues à NIC associados (attach) aos Buffers do pool, sem
+// cópia entre o kernel e o protocolo.
+//
+// Funciona em modo genérico (SKB), inclusive em pares veth. Um programa XDP
+// carregado pela própria Engine redireciona os quadros de
+// Config::ETHER_TYPE da fila Config::QUEUE_ID para o socket; só pode haver
+// uma XdpEngine por interface. Como o XDP só vê quadros de entrada, os
+// quadros enviados pela própria interface não voltam para ela.
+template <typename DataWrapper, typename Config = DefaultXdpConfig>
+class XdpEngine {
+public:
+  using FrameClass = DataWrapper;
+  using Frame = typename FrameClass::Frame;
+
+  // Tamanho da rajada usada pela NIC ao drenar o anel de recepção
+  static constexpr unsigned int RECEIVE_BURST = 32;
+
+  static constexpr unsigned int RX_FRAMES = Config::FRAME_COUNT / 2;
+
+public:
+  // Construtor: Cria a UMEM, o socket AF_XDP e carrega o programa XDP.
+  XdpEngine(const char *interface_name) : _interface_name(interface_name) {
+    if (!get_interface_info()) {
+      perror("XdpEngine Error: interface info");
+      exit(EXIT_FAILURE);
+    }
+
+    setupUmem();
+    setupSocket();
+    setupProgram();
+
+    turnRecvOn();
+#ifdef DEBUG
+    std::cout << "XdpEngine initialized for interface " << _interface_name
+              << " (queue " << Config::QUEUE_ID << ")" << std::endl;
+#endif
+  }
+
+  // Destrutor: Para a recepção e desfaz o programa XDP e a UMEM.
+  ~XdpEngine() {
+    stopReceiving();
+
+    // Fechar o link desanexa o programa XDP da interface
+    for (int fd : { _link_fd, _prog_fd, _map_fd }) {
+      if (fd != -1) {
+        close(fd);
+      }
+    }
+    // Os anéis são desmapeados antes do socket ser fechado
+    _rx.unmap();
+    _tx.unmap();
+    _fill.unmap();
+    _comp.unmap();
+    if (_xsk != -1) {
+      close(_xsk);
+    }
+    if (_umem != nullptr) {
+      munmap(_umem, umemSize());
+    }
+  }
+
+  // Envia um buffer pelo anel TX. Buffers associados a quadros de envio da
+  // UMEM (ver reserve()) são enviados sem cópia; os demais são copiados
+  // para um quadro livre.
+  // Args:
+  //   buf: Ponteiro para o Buffer contendo o quadro a ser enviado.
+  // Returns:
+  //   Número de bytes enviados ou -1 em caso de erro.
+  int send(Buffer *buf) {
+    if (!buf)
+      return -1;
+
+    std::lock_guard<std::mutex> lock(_tx_mtx);
+    reclaim();
+    if (_tx.freeSlots() == 0) {
+      return -1;
+    }
+
+    unsigned int frame;
+    if (isTxFrame(buf)) {
+      frame = buf->ext_ctx();
+      _tx_refs[frame - RX_FRAMES]++; // Referência do kernel
+    } else {
+      if (_tx_free.empty()) {
+        return -1;
+      }
+      frame = _tx_free.back();
+      _tx_free.pop_back();
+      _tx_refs[frame - RX_FRAMES] = 1;
+      std::memcpy(frameData(frame), buf->template data<std::byte>(),
+                  buf->size());
+    }
+
+    xdp_desc desc{};
+    desc.addr = frameAddr(frame);
+    desc.len = buf->size();
+    _tx.push(desc);
+
+    if (sendto(_xsk, nullptr, 0, MSG_DONTWAIT, nullptr, 0) < 0 &&
+        errno != EAGAIN && errno != EBUSY && errno != ENOBUFS) {
+#ifdef DEBUG
+      perror("XdpEngine::send sendto error");
+#endif
+      return -1;
+    }
+    return buf->size();
+  }
+
+  // Recebe um quadro do anel RX, associando o buffer ao quadro na UMEM.
+  // Args:
+  //   buf: Buffer do pool que será associado ao quadro.
+  // Returns:
+  //   Número de bytes recebidos ou 0 se não houver quadros.
+  int receive(Buffer *buf) {
+    xdp_desc desc;
+    if (!_rx.pop(desc)) {
+      buf->setSize(0);
+      return 0;
+    }
+    buf->attach(_umem + desc.addr, desc.addr / Config::FRAME_SIZE);
+    buf->setSize(desc.len);
+    return desc.len;
+  }
+
+  // Recebe uma rajada de quadros do anel RX.
+  // Returns:
+  //   Quantidade de quadros recebidos (os primeiros do vetor).
+  int receive_burst(Buffer **bufs, int n) {
+    int received = 0;
+    while (received < n && receive(bufs[received]) > 0) {
+      received++;
+    }
+    return received;
+  }
+
+  // Devolve à Engine um quadro da UMEM associado a um buffer.
+  // Args:
+  //   buf: Buffer associado por receive() ou reserve().
+  void release(Buffer *buf) {
+    unsigned int frame = buf->ext_ctx();
+    if (frame < RX_FRAMES) {
+      // Quadro de recepção volta para o anel fill
+      std::lock_guard<std::mutex> lock(_fill_mtx);
+      _fill.push(frameAddr(frame));
+    } else {
+      std::lock_guard<std::mutex> lock(_tx_mtx);
+      unref(frame);
+    }
+    buf->detach();
+  }
+
+  // Associa um buffer de envio a um quadro livre da UMEM, para que o quadro
+  // seja montado direto na memória lida pelo kernel.
+  // Returns:
+  //   false se não houver quadro livre (o buffer usa sua área interna).
+  bool reserve(Buffer *buf) {
+    std::lock_guard<std::mutex> lock(_tx_mtx);
+    reclaim();
+    if (_tx_free.empty()) {
+      return false;
+    }
+    unsigned int frame = _tx_free.back();
+    _tx_free.pop_back();
+    _tx_refs[frame - RX_FRAMES] = 1; // Referência do buffer
+    buf->attach(frameData(frame), frame);
+    return true;
+  }
+
+  const Ethernet::Address &getAddress() {
+    return _address;
+  }
+
+  // Encerra a thread de recepção. Usado por quem precisa parar a entrega
+  // de quadros antes de destruir o próprio estado (ex.: pools da NIC).
+  void stopReceiving() {
+    _recv.stop();
+  }
+
+  template <typename T, void (T::*handle_signal)()>
+  void bind(T *obj) {
+    _obj = obj;
+    _handler = &handlerWrapper<T, handle_signal>;
+    _recv.watch(_xsk, "xsk");
+  }
+
+private:
+  // Obtém MAC e índice da interface.
+  bool get_interface_info() {
+    _interface_index =
+        EngineHelpers::interfaceInfo(_interface_name, _address);
+    return _interface_index != 0;
+  }
+
+  // Aloca e registra a UMEM.
+  void setupUmem() {
+    void *umem = mmap(nullptr, umemSize(), PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
+    if (umem == MAP_FAILED) {
+      perror("mmap (umem)");
+      exit(EXIT_FAILURE);
+    }
+    _umem = static_cast<std::byte *>(umem);
+
+    _xsk = socket(AF_XDP, SOCK_RAW, 0);
+    if (_xsk == -1) {
+      perror("socket creation (AF_XDP)");
+      exit(EXIT_FAILURE);
+    }
+
+    struct xdp_umem_reg reg;
+    std::memset(&reg, 0, sizeof(reg));
+    reg.addr = reinterpret_cast<uint64_t>(_umem);
+    reg.len = umemSize();
+    reg.chunk_size = Config::FRAME_SIZE;
+    reg.headroom = 0;
+    if (setsockopt(_xsk, SOL_XDP, XDP_UMEM_REG, &reg, sizeof(reg)) < 0) {
+      perror("setsockopt XDP_UMEM_REG");
+      exit(EXIT_FAILURE);
+    }
+
+    _tx_refs.assign(Config::FRAME_COUNT - RX_FRAMES, 0);
+    for (unsigned int i = Config::FRAME_COUNT; i > RX_FRAMES; i--) {
+      _tx_free.push_back(i - 1);
+    }
+  }
+
+  // Configura e mapeia os anéis e faz o bind do socket à fila.
+  void setupSocket() {
+    unsigned int size = Config::RING_SIZE;
+    for (int opt : { XDP_UMEM_FILL_RING, XDP_UMEM_COMPLETION_RING, XDP_RX_RING,
+                     XDP_TX_RING }) {
+      if (setsockopt(_xsk, SOL_XDP, opt, &size, sizeof(size)) < 0) {
+        perror("setsockopt (xdp ring)");
+        exit(EXIT_FAILURE);
+      }
+    }
+
+    struct xdp_mmap_offsets off;
+    socklen_t optlen = sizeof(off);
+    if (getsockopt(_xsk, SOL_XDP, XDP_MMAP_OFFSETS, &off, &optlen) < 0) {
+      perror("getsockopt XDP_MMAP_OFFSETS");
+      exit(EXIT_FAILURE);
+    }
+
+    if (!_fill.map(_xsk, XDP_UMEM_PGOFF_FILL_RING, off.fr, size) ||
+        !_comp.map(_xsk, XDP_UMEM_PGOFF_COMPLETION_RING, off.cr, size) ||
+        !_rx.map(_xsk, XDP_PGOFF_RX_RING, off.rx, size) ||
+        !_tx.map(_xsk, XDP_PGOFF_TX_RING, off.tx, size)) {
+      perror("mmap (xdp ring)");
+      exit(EXIT_FAILURE);
+    }
+
+    // Entrega ao kernel os quadros de recepção
+    for (unsigned int i = 0; i < RX_FRAMES && _fill.freeSlots() > 0; i++) {
+      _fill.push(frameAddr(i));
+    }
+
+    struct sockaddr_xdp sxdp;
+    std::memset(&sxdp, 0, sizeof(sxdp));
+    sxdp.sxdp_family = AF_XDP;
+    sxdp.sxdp_ifindex = _interface_index;
+    sxdp.sxdp_queue_id = Config::QUEUE_ID;
+    // Modo cópia: funciona com qualquer driver, inclusive XDP genérico
+    sxdp.sxdp_flags = XDP_COPY;
+    if (::bind(_xsk, (struct sockaddr *)&sxdp, sizeof(sxdp)) < 0) {
+      perror("bind (AF_XDP socket)");
+      exit(EXIT_FAILURE);
+    }
+  }
+
+  // Cria o XSKMAP, carrega o programa XDP e o anexa à interface em modo
+  // genérico (SKB).
+  void setupProgram() {
+    union bpf_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.map_type = BPF_MAP_TYPE_XSKMAP;
+    attr.key_size = sizeof(uint32_t);
+    attr.value_size = sizeof(uint32_t);
+    attr.max_entries = Config::QUEUE_ID + 1;
+    _map_fd = bpf(BPF_MAP_CREATE, attr);
+    if (_map_fd < 0) {
+      perror("bpf BPF_MAP_CREATE (xskmap)");
+      exit(EXIT_FAILURE);
+    }
+
+    uint32_t key = Config::QUEUE_ID;
+    uint32_t value = _xsk;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.map_fd = _map_fd;
+    attr.key = reinterpret_cast<uint64_t>(&key);
+    attr.value = reinterpret_cast<uint64_t>(&value);
+    if (bpf(BPF_MAP_UPDATE_ELEM, attr) < 0) {
+      perror("bpf BPF_MAP_UPDATE_ELEM (xskmap)");
+      exit(EXIT_FAILURE);
+    }
+
+    // Redireciona para o socket os quadros com o EtherType do protocolo;
+    // os demais (e os de filas sem socket) seguem para a pilha do kernel.
+    const int32_t ether_type = htons(Config::ETHER_TYPE);
+    struct bpf_insn prog[] = {
+      insn(BPF_ALU64 | BPF_MOV | BPF_X, 6, 1, 0, 0),     // r6 = ctx
+      insn(BPF_LDX | BPF_W | BPF_MEM, 2, 6, 0, 0),       // r2 = data
+      insn(BPF_LDX | BPF_W | BPF_MEM, 3, 6, 4, 0),       // r3 = data_end
+      insn(BPF_ALU64 | BPF_MOV | BPF_X, 4, 2, 0, 0),     // r4 = data
+      insn(BPF_ALU64 | BPF_ADD | BPF_K, 4, 0, 0, 14),    // r4 += ETH_HLEN
+      insn(BPF_JMP | BPF_JGT | BPF_X, 4, 3, 8, 0),       // curto: pass
+      insn(BPF_LDX | BPF_H | BPF_MEM, 4, 2, 12, 0),      // r4 = ethertype
+      insn(BPF_JMP | BPF_JNE | BPF_K, 4, 0, 6, ether_type), // outro: pass
+      insn(BPF_LDX | BPF_W | BPF_MEM, 2, 6, 16, 0),      // r2 = rx_queue
+      insn(BPF_LD | BPF_DW | BPF_IMM, 1, BPF_PSEUDO_MAP_FD, 0, _map_fd),
+      insn(0, 0, 0, 0, 0),                               // (ld_imm64)
+      insn(BPF_ALU64 | BPF_MOV | BPF_K, 3, 0, 0, XDP_PASS), // falha: pass
+      insn(BPF_JMP | BPF_CALL, 0, 0, 0, BPF_FUNC_redirect_map),
+      insn(BPF_JMP | BPF_EXIT, 0, 0, 0, 0),
+      insn(BPF_ALU64 | BPF_MOV | BPF_K, 0, 0, 0, XDP_PASS), // pass:
+      insn(BPF_JMP | BPF_EXIT, 0, 0, 0, 0),
+    };
+    static const char license[] = "GPL";
+
+    std::memset(&attr, 0, sizeof(attr));
+    attr.prog_type = BPF_PROG_TYPE_XDP;
+    attr.insns = reinterpret_cast<uint64_t>(prog);
+    attr.insn_cnt = sizeof(prog) / sizeof(prog[0]);
+    attr.license = reinterpret_cast<uint64_t>(license);
+    _prog_fd = bpf(BPF_PROG_LOAD, attr);
+    if (_prog_fd < 0) {
+      perror("bpf BPF_PROG_LOAD (xdp)");
+      exit(EXIT_FAILURE);
+    }
+
+    // O link mantém o programa anexado enquanto estiver aberto
+    std::memset(&attr, 0, sizeof(attr));
+    attr.link_create.prog_fd = _prog_fd;
+    attr.link_create.target_ifindex = _interface_index;
+    attr.link_create.attach_type = BPF_XDP;
+    attr.link_create.flags = XDP_FLAGS_SKB_MODE;
+    _link_fd = bpf(BPF_LINK_CREATE, attr);
+    if (_link_fd < 0) {
+      perror("bpf BPF_LINK_CREATE (xdp)");
+      exit(EXIT_FAILURE);
+    }
+  }
+
+  // Dispara a thread de recepção, que chama o handler da NIC a cada evento
+  // do socket.
+  void turnRecvOn() {
+    _recv.start([this]() { _handler(_obj); });
+  }
+
+  template <typename T, void (T::*handle_signal)()>
+  static void handlerWrapper(void *obj) {
+    T *typedObj = static_cast<T *>(obj);
+    (typedObj->*handle_signal)();
+  }
+
+  // Devolve à lista livre os quadros de envio já transmitidos.
+  // Deve ser chamado com _tx_mtx travado.
+  void reclaim() {
+    uint64_t addr;
+    while (_comp.pop(addr)) {
+      unref(addr / Config::FRAME_SIZE);
+    }
+  }
+
+  // Solta uma referência (buffer ou kernel) de um quadro de envio.
+  // Deve ser chamado com _tx_mtx travado.
+  void unref(unsigned int frame) {
+    if (--_tx_refs[frame - RX_FRAMES] == 0) {
+      _tx_free.push_back(frame);
+    }
+  }
+
+  bool isTxFrame(Buffer *buf) {
+    return buf->is_attached() && buf->ext_ctx() >= (int)RX_FRAMES &&
+           buf->template data<std::byte>() == frameData(buf->ext_ctx());
+  }
+
+  static uint64_t frameAddr(unsigned int frame) {
+    return static_cast<uint64_t>(frame) * Config::FRAME_SIZE;
+  }
+
+  std::byte *frameData(unsigned int frame) {
+    return _umem + frameAddr(frame);
+  }
+
+  static size_t umemSize() {
+    return static_cast<size_t>(Config::FRAME_COUNT) * Config::FRAME_SIZE;
+  }
+
+  static struct bpf_insn insn(uint8_t code, uint8_t dst, uint8_t src,
+                              int16_t off, int32_t imm) {
+    struct bpf_insn i;
+    std::memset(&i, 0, sizeof(i));
+    i.code = code;
+    i.dst_reg = dst;
+    i.src_reg = src;
+    i.off = off;
+    i.imm = imm;
+    return i;
+  }
+
+  static int bpf(int cmd, union bpf_attr &attr) {
+    return syscall(__NR_bpf, cmd, &attr, sizeof(attr));
+  }
+
+  const char *_interface_name;
+  unsigned int _interface_index = 0;
+  Ethernet::Address _address;
+
+  // UMEM e socket AF_XDP
+  std::byte *_umem = nullptr;
+  int _xsk = -1;
+  XskRing<uint64_t> _fill;
+  XskRing<uint64_t> _comp;
+  XskRing<xdp_desc> _rx;
+  XskRing<xdp_desc> _tx;
+  // O anel fill é produzido por quem libera buffers (qualquer thread)
+  std::mutex _fill_mtx;
+  // Quadros de envio: lista livre e referências (buffer e kernel)
+  std::mutex _tx_mtx;
+  std::vector<unsigned int> _tx_free;
+  std::vector<int> _tx_refs;
+
+  // Programa XDP
+  int _map_fd = -1;
+  int _prog_fd = -1;
+  int _link_fd = -1;
+
+  // Objeto (NIC) e função chamados a cada evento de recepção
+  void *_obj = nullptr;
+  void (*_handler)(void *) = nullptr;
+
+  // ---- Controle da thread de recepcao ----
+  EngineHelpers::RecvThread _recv;
+};
+
+#endif
@@ -30,11 +30,6 @@ Ethernet::Address::operator bool() const {
   return std::memcmp(mac, Ethernet::ZERO, sizeof(mac)) != 0;
 }
 
-// Implementação do construtor de Statistics
-Ethernet::Statistics::Statistics()
-    : tx_packets(0), tx_bytes(0), rx_packets(0), rx_bytes(0) {
-}
-
 const unsigned char Ethernet::BROADCAST_ADDRESS[6] = { 0xFF, 0xFF, 0xFF,
                                                        0xFF, 0xFF, 0xFF };
 const unsigned char Ethernet::ZERO[6] = { 0, 0, 0, 0, 0, 0 };
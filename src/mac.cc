@@ -12,6 +12,12 @@
 
 namespace MAC {
 
+// Inicializa a OpenSSL antes do main e sem o handler de atexit: as threads de
+// recepção e de sincronização ainda podem calcular MACs enquanto o processo
+// encerra, e a limpeza da biblioteca nesse momento derruba o processo.
+[[maybe_unused]] static const bool crypto_initialized =
+    OPENSSL_init_crypto(OPENSSL_INIT_NO_ATEXIT, nullptr) == 1;
+
 MAC::Tag compute(const MAC::Key &key, const std::vector<std::byte> &message) {
   if (key == MAC::Key{}) {
     return MAC::Tag{};
@@ -30,11 +30,6 @@ SharedMem::Address::operator bool() const {
   return std::memcmp(mac, SharedMem::ZERO, sizeof(mac)) != 0;
 }
 
-// Implementação do construtor de Statistics
-SharedMem::Statistics::Statistics()
-    : tx_packets(0), tx_bytes(0), rx_packets(0), rx_bytes(0) {
-}
-
 const unsigned char SharedMem::BROADCAST_ADDRESS[6] = { 0xFF, 0xFF, 0xFF,
                                                        0xFF, 0xFF, 0xFF };
 const unsigned char SharedMem::ZERO[6] = { 0, 0, 0, 0, 0, 0 };
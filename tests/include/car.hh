@@ -43,13 +43,15 @@ public:
   const std::string label;
 };
 
+// SocketEngine permite trocar a Engine do socket (ex.: política de recepção)
+template <typename SocketEngine = Engine<Ethernet>>
 class E7Car {
 public:
-  using SocketNIC = NIC<Engine<Ethernet>>;
+  using SocketNIC = NIC<SocketEngine>;
   using SharedMemNIC = NIC<SharedEngine<SharedMem>>;
   using ProtocolC = Protocol<SocketNIC, SharedMemNIC, NavigatorDirected>;
   using ComponentC = Component<ProtocolC>;
-  using Port = ComponentC::PortC;
+  using Port = typename ComponentC::PortC;
   using Coordinate = NavigatorDirected::Coordinate;
 
   static constexpr SmartUnit cam_unit = CAMTransducer::get_unit();
@@ -76,7 +78,7 @@ public:
     return ComponentC(&prot, p);
   }
 
-  bool receive(ComponentC::MessageC *msg) {
+  bool receive(typename ComponentC::MessageC *msg) {
     return CAM_subs.receive(msg);
   }
 
@@ -100,9 +102,10 @@ public:
   ProtocolC &prot;
   const std::string label;
   ComponentC baseComp;
-  SmartData<ComponentC::CommunicatorC, Condition> CAM_subs;
+  SmartData<typename ComponentC::CommunicatorC, Condition> CAM_subs;
   CAMTransducer CAM_trand;
-  SmartData<ComponentC::CommunicatorC, Condition, CAMTransducer> CAM_prod;
+  SmartData<typename ComponentC::CommunicatorC, Condition, CAMTransducer>
+      CAM_prod;
   std::string _dataset_id;
 };
 
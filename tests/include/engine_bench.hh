@@ -0,0 +1,160 @@
+#ifndef ENGINE_BENCH_HH
+#define ENGINE_BENCH_HH
+
+#include "engine.hh"
+#include "ethernet.hh"
+#include "frame_counter.hh"
+#include "nic.hh"
+#include "sync_engine.hh"
+#include "veth.hh"
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <semaphore.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+
+// Vazão de recepção de uma Engine em um par veth: um processo envia
+// NUM_FRAMES quadros por uma ponta e outro os conta na outra. Usado pelos
+// testes perf_*_engine_test para comparar uma Engine com a de socket raw e
+// pelo perf_rx_modes_test para comparar os modos da própria Engine.
+namespace EngineBench {
+
+constexpr long long NUM_FRAMES = 200000;
+constexpr size_t PAYLOAD_SIZE = 64;
+constexpr int IDLE_TIMEOUT_MS = 1000;
+constexpr unsigned short PROTO = 0x88B5;
+
+// Indica se um processo filho terminou normalmente com código 0.
+inline bool exited_ok(int status) {
+  return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+// Mede a Engine SocketEngine enviando por send_iface e recebendo por
+// recv_iface, e imprime o resultado sob o título name.
+// Returns:
+//   false se o processo emissor ou o receptor terminou com erro.
+template <typename SocketEngine>
+bool run(const char *name, const char *send_iface, const char *recv_iface) {
+  using BenchNIC = NIC<SocketEngine>;
+
+  FrameCount *result = static_cast<FrameCount *>(
+      mmap(NULL, sizeof(FrameCount), PROT_READ | PROT_WRITE,
+           MAP_SHARED | MAP_ANONYMOUS, -1, 0));
+  sem_t *ready = static_cast<sem_t *>(mmap(NULL, sizeof(sem_t),
+                                           PROT_READ | PROT_WRITE,
+                                           MAP_SHARED | MAP_ANONYMOUS, -1, 0));
+  if (result == MAP_FAILED || ready == MAP_FAILED) {
+    std::cerr << "Erro ao criar memória compartilhada." << std::endl;
+    exit(1);
+  }
+  new (result) FrameCount{};
+  sem_init(ready, 1, 0);
+
+  std::cout << "==== " << name << " ====" << std::endl;
+
+  pid_t receiver = fork();
+  if (receiver < 0) {
+    std::cerr << "Erro ao criar processo" << std::endl;
+    exit(1);
+  }
+  if (receiver == 0) {
+    SimulatedClock clock;
+    BenchNIC nic(recv_iface, &clock);
+    FrameCounter<BenchNIC> counter(&nic, result, htons(PROTO));
+    sem_post(ready);
+
+    // Termina após IDLE_TIMEOUT_MS sem novos quadros
+    long long last = -1;
+    while (true) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(IDLE_TIMEOUT_MS));
+      long long received = result->received.load();
+      if (received == last || received >= NUM_FRAMES) {
+        break;
+      }
+      last = received;
+    }
+    exit(0);
+  }
+
+  sem_wait(ready);
+
+  pid_t sender = fork();
+  if (sender < 0) {
+    std::cerr << "Erro ao criar processo" << std::endl;
+    exit(1);
+  }
+  if (sender == 0) {
+    SimulatedClock clock;
+    BenchNIC nic(send_iface, &clock);
+    Ethernet::Address src = nic.address();
+    long long sent = 0;
+    long long start = now_us();
+    while (sent < NUM_FRAMES) {
+      Buffer *buf = nic.alloc(1);
+      if (buf == nullptr) {
+        continue;
+      }
+      auto *frame = buf->template data<Ethernet::Frame>();
+      std::memcpy(frame->dst.mac, Ethernet::BROADCAST_ADDRESS, 6);
+      frame->src = src;
+      frame->prot = htons(PROTO);
+      std::memset(frame->template data<std::byte>(), 0xAB, PAYLOAD_SIZE);
+      buf->setSize(Ethernet::HEADER_SIZE + PAYLOAD_SIZE);
+      if (nic.send(buf) > 0) {
+        sent++;
+      }
+      nic.free(buf);
+    }
+    long long elapsed = now_us() - start;
+    std::cout << "Enviados: " << sent << " quadros em " << elapsed / 1000
+              << " ms" << std::endl;
+    exit(0);
+  }
+
+  int sender_status;
+  int receiver_status;
+  waitpid(sender, &sender_status, 0);
+  waitpid(receiver, &receiver_status, 0);
+  bool ok = exited_ok(sender_status) && exited_ok(receiver_status);
+  if (!ok) {
+    std::cerr << "Processo emissor ou receptor terminou com erro."
+              << std::endl;
+  }
+
+  long long received = result->received.load();
+  std::cout << "Recebidos: " << received << " de " << NUM_FRAMES << " ("
+            << (NUM_FRAMES - received) << " perdidos)" << std::endl;
+  if (result->rate() > 0) {
+    std::cout << "Vazão de recepção: " << result->rate() << " quadros/s"
+              << std::endl;
+  }
+
+  sem_destroy(ready);
+  munmap(ready, sizeof(sem_t));
+  munmap(result, sizeof(FrameCount));
+  return ok;
+}
+
+// Cria o par veth send_iface/recv_iface e mede a Engine de socket raw e a
+// Engine Candidate, nessa ordem.
+// Returns:
+//   Código de saída do teste (SKIP_EXIT_CODE sem o par veth).
+template <typename Candidate>
+int compare_with_raw_socket(const char *name, const char *send_iface,
+                            const char *recv_iface) {
+  VethPair veth(send_iface, recv_iface);
+  if (!veth.up()) {
+    return veth.skip();
+  }
+  bool ok = run<Engine<Ethernet>>("Engine (socket raw)", send_iface,
+                                  recv_iface);
+  ok &= run<Candidate>(name, send_iface, recv_iface);
+  return ok ? 0 : 1;
+}
+
+} // namespace EngineBench
+
+#endif
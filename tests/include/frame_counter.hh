@@ -0,0 +1,73 @@
+#ifndef FRAME_COUNTER_HH
+#define FRAME_COUNTER_HH
+
+#include "buffer.hh"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+// Instante atual em microssegundos no relógio Clock.
+template <typename Clock = std::chrono::steady_clock>
+int64_t now_us() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             Clock::now().time_since_epoch())
+      .count();
+}
+
+// Quadros contados por um FrameCounter. Pode morar em memória compartilhada
+// (mmap) para ser lida por outro processo.
+struct FrameCount {
+  std::atomic<long long> received{ 0 };
+  std::atomic<long long> first_us{ 0 };
+  std::atomic<long long> last_us{ 0 };
+
+  // Quadros por segundo entre o primeiro e o último recebido, ou 0.
+  double rate() const {
+    long long span = last_us.load() - first_us.load();
+    return span > 0 ? received.load() * 1000000.0 / span : 0;
+  }
+};
+
+// Observador que conta os quadros de um protocolo entregues pela NIC e os
+// devolve imediatamente. Testes que precisam olhar o conteúdo sobrescrevem
+// inspect().
+template <typename NICType>
+class FrameCounter : public NICType::Observer {
+public:
+  // Args:
+  //   nic: NIC observada.
+  //   count: Onde contar os quadros.
+  //   proto: Protocolo observado, já na ordem de bytes do quadro.
+  FrameCounter(NICType *nic, FrameCount *count,
+               typename NICType::Protocol_Number proto)
+      : _nic(nic), _count(count), _proto(proto) {
+    _nic->attach(this, _proto);
+  }
+
+  virtual ~FrameCounter() {
+    _nic->detach(this, _proto);
+  }
+
+  void update([[maybe_unused]] typename NICType::Observed *obs,
+              [[maybe_unused]] typename NICType::Protocol_Number c,
+              Buffer *buf) override {
+    inspect(buf);
+    long long t = now_us();
+    if (_count->received.fetch_add(1) == 0) {
+      _count->first_us.store(t);
+    }
+    _count->last_us.store(t);
+    _nic->free(buf);
+  }
+
+protected:
+  // Chamado com cada quadro antes de ele ser contado e liberado.
+  virtual void inspect([[maybe_unused]] Buffer *buf) {
+  }
+
+  NICType *_nic;
+  FrameCount *_count;
+  typename NICType::Protocol_Number _proto;
+};
+
+#endif
@@ -0,0 +1,68 @@
+#ifndef VETH_HH
+#define VETH_HH
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+
+// Código de saída de um teste pulado (mesma convenção do automake). Quem
+// roda os testes o distingue de sucesso (0) e de falha.
+constexpr int SKIP_EXIT_CODE = 77;
+
+// Par veth criado por um teste e removido ao fim do escopo. Criar o par
+// requer root; sem ele, o teste deve ser pulado com skip().
+class VethPair {
+public:
+  VethPair(const char *first, const char *second)
+      : _first(first), _second(second) {
+    std::string cmd = std::string("ip link add ") + _first +
+                      " type veth peer name " + _second + " && ip link set " +
+                      _first + " up && ip link set " + _second + " up";
+    _up = system(cmd.c_str()) == 0;
+    if (_up) {
+      // Aguarda o enlace do veth subir
+      std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    }
+  }
+
+  ~VethPair() {
+    remove();
+  }
+
+  VethPair(const VethPair &) = delete;
+  VethPair &operator=(const VethPair &) = delete;
+
+  bool up() const {
+    return _up;
+  }
+
+  // Remove o par antes do fim do escopo (ex.: antes de um _exit).
+  void remove() {
+    if (!_up) {
+      return;
+    }
+    _up = false;
+    std::string cmd = std::string("ip link del ") + _first;
+    if (system(cmd.c_str()) != 0) {
+      std::cerr << "Não foi possível remover o par veth." << std::endl;
+    }
+  }
+
+  // Informa que o teste foi pulado por falta do par.
+  // Returns:
+  //   SKIP_EXIT_CODE, para ser retornado por main.
+  int skip() const {
+    std::cout << "SKIP: não foi possível criar o par veth " << _first << "/"
+              << _second << " (requer root)" << std::endl;
+    return SKIP_EXIT_CODE;
+  }
+
+private:
+  const char *_first;
+  const char *_second;
+  bool _up = false;
+};
+
+#endif
@@ -6,6 +6,7 @@
 #include "protocol.hh"
 #include "shared_engine.hh"
 #include "shared_mem.hh"
+#include <algorithm>
 #include <chrono>
 #include <cstdlib>
 #include <cstring>
@@ -15,6 +16,7 @@
 #include <sys/mman.h>
 #include <sys/wait.h>
 #include <unistd.h>
+#include <vector>
 
 using namespace std;
 using namespace std::chrono;
@@ -28,8 +30,26 @@ const int timeout_sec = 10;
 #define INTERFACE_NAME "lo"
 #endif
 
-int main() {
-  std::cout << "\n\n\n\033[3A" << std::flush;
+// Políticas de recepção comparadas pelo teste
+struct AdaptiveConfig : DefaultEngineConfig {
+  static constexpr RxPolicy RX_POLICY = RxPolicy::Adaptive;
+};
+
+struct BusyPollConfig : DefaultEngineConfig {
+  static constexpr RxPolicy RX_POLICY = RxPolicy::BusyPoll;
+};
+
+// Retorna o percentil p (0 a 100) das latências já ordenadas
+long long percentile(const vector<long long> &sorted, double p) {
+  if (sorted.empty()) {
+    return 0;
+  }
+  size_t idx = static_cast<size_t>(p / 100.0 * (sorted.size() - 1));
+  return sorted[idx];
+}
+
+template <typename SocketEngine>
+void run_latency() {
   // Criação do semaphore compartilhado
   sem_t *semaphore =
       static_cast<sem_t *>(mmap(NULL, sizeof(sem_t), PROT_READ | PROT_WRITE,
@@ -47,10 +67,10 @@ int main() {
     exit(1);
   }
 
-  using SocketNIC = NIC<Engine<Ethernet>>;
+  using SocketNIC = NIC<SocketEngine>;
   using SharedMemNIC = NIC<SharedEngine<SharedMem>>;
   using Protocol = Protocol<SocketNIC, SharedMemNIC, NavigatorDirected>;
-  using Message = Message<Protocol::Address, Protocol>;
+  using Message = Message<typename Protocol::Address, Protocol>;
   using Communicator = Communicator<Protocol, Message>;
 
   if (pid == 0) {
@@ -67,7 +87,7 @@ int main() {
     for (int j = 0; j < num_messages_per_comm;) {
       Message msg =
           Message(communicator.addr(),
-                  Protocol::Address(prot.getNICPAddr(), parentPID, 11),
+                  typename Protocol::Address(prot.getNICPAddr(), parentPID, 11),
                   MESSAGE_SIZE, Control(Control::Type::COMMON), &prot);
       memset(msg.data(), 0, MESSAGE_SIZE);
       // Registra o timestamp no envio
@@ -95,6 +115,8 @@ int main() {
 
     long long total_latency_us = 0;
     int msg_count = 0;
+    vector<long long> latencies;
+    latencies.reserve(num_messages_per_comm);
     Message msg(MESSAGE_SIZE, Control(Control::Type::COMMON), &prot);
 
     // Libera o semaphore para que o filho inicie o envio
@@ -118,6 +140,7 @@ int main() {
             duration_cast<microseconds>(t_recv.time_since_epoch()).count();
         long long latency_us = t_recv_us - t_sent_us;
         total_latency_us += latency_us;
+        latencies.push_back(latency_us);
         msg_count++;
         std::cout << "\033[2B\rReceived: " << std::dec << msg_count
                   << "\033[K\033[2A" << std::flush;
@@ -140,6 +163,15 @@ int main() {
         (msg_count > 0 ? static_cast<double>(total_latency_us) / msg_count : 0);
     cout << "Latência média observada: " << avg_latency_us << " μs" << endl;
 
+    // Latência de cauda
+    vector<long long> sorted(latencies.begin(), latencies.begin() + msg_count);
+    sort(sorted.begin(), sorted.end());
+    cout << "Latência p50: " << percentile(sorted, 50) << " μs" << endl;
+    cout << "Latência p99: " << percentile(sorted, 99) << " μs" << endl;
+    cout << "Latência p99.9: " << percentile(sorted, 99.9) << " μs" << endl;
+    cout << "Latência máxima: " << (sorted.empty() ? 0 : sorted.back())
+         << " μs" << endl;
+
     // Libera recursos do semaphore compartilhado
     sem_destroy(semaphore);
     munmap(semaphore, sizeof(sem_t));
@@ -148,6 +180,30 @@ int main() {
       exit(0);
     }
   }
+}
 
+// Executa o teste em um processo separado para cada política, pois cada
+// execução mantém sua própria instância de Protocol.
+template <typename SocketEngine>
+void run_variant(const char *name) {
+  std::cout << "==== Política de recepção " << name << " ====" << std::endl;
+  std::cout << "\n\n\n\033[3A" << std::flush;
+  pid_t pid = fork();
+  if (pid < 0) {
+    cerr << "Erro ao criar processo" << endl;
+    exit(1);
+  }
+  if (pid == 0) {
+    run_latency<SocketEngine>();
+    exit(0);
+  }
+  int status;
+  waitpid(pid, &status, 0);
+}
+
+int main() {
+  run_variant<Engine<Ethernet>>("Blocking");
+  run_variant<Engine<Ethernet, AdaptiveConfig>>("Adaptive");
+  run_variant<Engine<Ethernet, BusyPollConfig>>("BusyPoll");
   return 0;
 }
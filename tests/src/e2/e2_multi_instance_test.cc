@@ -0,0 +1,145 @@
+#include "communicator.hh"
+#include "engine.hh"
+#include "message.hh"
+#include "navigator.hh"
+#include "nic.hh"
+#include "protocol.hh"
+#include "shared_engine.hh"
+#include "shared_mem.hh"
+#include "shm_medium_engine.hh"
+#include "topology.hh"
+#include "veth.hh"
+#include <chrono>
+#include <cstring>
+#include <future>
+#include <iostream>
+#include <string>
+#include <unistd.h>
+
+// Duas pilhas de protocolo completas no mesmo processo. Cada pilha envia
+// NUM_MSGS mensagens para a outra e confere o conteúdo recebido. As pilhas
+// compartilham primeiro um meio em memória compartilhada, o que não requer
+// root; com root, repetem a troca cada uma em uma ponta de um par veth
+// criado pelo teste.
+
+constexpr const char *IFACE_A = "multi0";
+constexpr const char *IFACE_B = "multi1";
+constexpr int NUM_MSGS = 100;
+constexpr int MSG_SIZE = 8;
+constexpr int TIMEOUT_SEC = 10;
+// Resultado de exchange() quando as mensagens não chegam a tempo
+constexpr int TIMED_OUT = -1;
+
+// Envia NUM_MSGS mensagens numeradas de from para to
+template <typename Message, typename Communicator, typename Protocol>
+void send_all(Communicator &comm, Protocol &from,
+              typename Protocol::Address to) {
+  for (int i = 0; i < NUM_MSGS;) {
+    Message msg(comm.addr(), to, MSG_SIZE, Control(Control::Type::COMMON),
+                &from);
+    int64_t value = i;
+    std::memcpy(msg.data(), &value, sizeof(value));
+    if (comm.send(&msg)) {
+      i++;
+    }
+  }
+}
+
+// Recebe NUM_MSGS mensagens e retorna quantas chegaram na ordem esperada
+template <typename Message, typename Communicator, typename Protocol>
+int receive_all(Communicator &comm, Protocol &prot) {
+  int in_order = 0;
+  for (int i = 0; i < NUM_MSGS; i++) {
+    Message msg(MSG_SIZE, Control(Control::Type::COMMON), &prot);
+    if (!comm.receive(&msg)) {
+      break;
+    }
+    int64_t value;
+    std::memcpy(&value, msg.data(), sizeof(value));
+    if (value == i) {
+      in_order++;
+    }
+  }
+  return in_order;
+}
+
+// Cria duas pilhas sobre SocketEngine, uma em iface_a e outra em iface_b, e
+// troca mensagens entre elas.
+// Returns:
+//   0 se todas chegaram em ordem, 1 se não, ou TIMED_OUT. Neste caso as
+//   threads de recepção continuam bloqueadas e o chamador deve encerrar o
+//   processo sem retornar.
+template <typename SocketEngine>
+int exchange(const char *iface_a, const char *iface_b) {
+  using SocketNIC = NIC<SocketEngine>;
+  using SharedMemNIC = NIC<SharedEngine<SharedMem>>;
+  using Protocol = Protocol<SocketNIC, SharedMemNIC, NavigatorDirected>;
+  using Message = Message<typename Protocol::Address, Protocol>;
+  using Communicator = Communicator<Protocol, Message>;
+
+  Topology topo({ 1, 1 }, 10);
+  NavigatorCommon::Coordinate point(0, 0);
+  Protocol prot_a(iface_a, getpid(), { point }, topo, 10, 0);
+  Protocol prot_b(iface_b, getpid() + 1, { point }, topo, 10, 0);
+  Communicator comm_a(&prot_a, 10);
+  Communicator comm_b(&prot_b, 11);
+
+  typename Protocol::Address addr_a(prot_a.getNICPAddr(), prot_a.getSysID(),
+                                    10);
+  typename Protocol::Address addr_b(prot_b.getNICPAddr(), prot_b.getSysID(),
+                                    11);
+
+  auto recv_a = std::async(std::launch::async,
+                           [&]() { return receive_all<Message>(comm_a, prot_a); });
+  auto recv_b = std::async(std::launch::async,
+                           [&]() { return receive_all<Message>(comm_b, prot_b); });
+
+  std::thread send_a([&]() { send_all<Message>(comm_a, prot_a, addr_b); });
+  std::thread send_b([&]() { send_all<Message>(comm_b, prot_b, addr_a); });
+  send_a.join();
+  send_b.join();
+
+  auto deadline =
+      std::chrono::steady_clock::now() + std::chrono::seconds(TIMEOUT_SEC);
+  if (recv_a.wait_until(deadline) == std::future_status::timeout ||
+      recv_b.wait_until(deadline) == std::future_status::timeout) {
+    std::cerr << "Timeout na recepção de mensagens." << std::endl;
+    return TIMED_OUT;
+  }
+
+  int in_order_a = recv_a.get();
+  int in_order_b = recv_b.get();
+  std::cout << iface_a << " (A) recebeu " << in_order_a << " de " << NUM_MSGS
+            << " mensagens em ordem" << std::endl;
+  std::cout << iface_b << " (B) recebeu " << in_order_b << " de " << NUM_MSGS
+            << " mensagens em ordem" << std::endl;
+  return (in_order_a == NUM_MSGS && in_order_b == NUM_MSGS) ? 0 : 1;
+}
+
+int main() {
+  // Meio exclusivo deste teste, sem root
+  std::string medium = "e2multi" + std::to_string(getpid());
+  int result = exchange<ShmMediumEngine<Ethernet>>(medium.c_str(),
+                                                   medium.c_str());
+  ShmMediumEngine<Ethernet>::destroyMedium(medium.c_str());
+  if (result == TIMED_OUT) {
+    // Encerra sem destruir as pilhas
+    _exit(1);
+  }
+  if (result != 0) {
+    return 1;
+  }
+
+  VethPair veth(IFACE_A, IFACE_B);
+  if (!veth.up()) {
+    // A variante sem root já passou: só a do par veth fica de fora
+    veth.skip();
+    return 0;
+  }
+  result = exchange<Engine<Ethernet>>(IFACE_A, IFACE_B);
+  if (result == TIMED_OUT) {
+    veth.remove();
+    _exit(1);
+  }
+  return result;
+}
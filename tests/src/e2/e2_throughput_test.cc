@@ -158,6 +158,11 @@ int main() {
         munmap(semaphore, sizeof(sem_t));
         munmap(has_timed_out, sizeof(bool));
 
+        // Uma falha do remetente falha o teste
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+          cerr << "Processo remetente terminou com erro." << endl;
+          exit(1);
+        }
         exit(0);
       }
 
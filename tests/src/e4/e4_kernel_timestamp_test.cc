@@ -0,0 +1,145 @@
+#include "engine.hh"
+#include "ethernet.hh"
+#include "frame_counter.hh"
+#include "nic.hh"
+#include "sync_engine.hh"
+#include "veth.hh"
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <semaphore.h>
+#include <unistd.h>
+
+// Verifica os timestamps do kernel (SO_TIMESTAMPING) usados pela
+// sincronização: cada quadro enviado por uma ponta de um par veth deve ter
+// instante de transmissão, e o quadro recebido na outra ponta deve chegar
+// com o instante de recepção do kernel, anterior ao momento em que a thread
+// de recepção o trata.
+
+constexpr const char *SEND_IFACE = "tstamp0";
+constexpr const char *RECV_IFACE = "tstamp1";
+constexpr int NUM_FRAMES = 100;
+constexpr int TIMEOUT_SEC = 5;
+constexpr unsigned short PROTO = 0x88B5;
+// Posição do número de sequência do quadro, logo após o cabeçalho Ethernet
+constexpr unsigned int SEQ_OFFSET = Ethernet::HEADER_SIZE;
+
+using RecvNIC = NIC<Engine<Ethernet>>;
+
+// Anota, para cada quadro, o timestamp do kernel e o instante do tratamento
+class Stamper : public FrameCounter<RecvNIC> {
+public:
+  Stamper(RecvNIC *nic, sem_t *received)
+      : FrameCounter<RecvNIC>(nic, &_count, htons(PROTO)),
+        _received(received) {
+  }
+
+  int64_t kernel_rx[NUM_FRAMES] = {};
+  int64_t receive_time[NUM_FRAMES] = {};
+  int64_t handled_at[NUM_FRAMES] = {};
+
+protected:
+  void inspect(Buffer *buf) override {
+    // Timestamps do kernel usam o relógio de parede
+    int64_t handled = now_us<std::chrono::system_clock>();
+    int seq;
+    std::memcpy(&seq, buf->template data<std::byte>() + SEQ_OFFSET,
+                sizeof(seq));
+    if (seq >= 0 && seq < NUM_FRAMES) {
+      kernel_rx[seq] = buf->get_kernel_time();
+      receive_time[seq] = buf->get_receive_time();
+      handled_at[seq] = handled;
+      sem_post(_received);
+    }
+  }
+
+private:
+  FrameCount _count;
+  sem_t *_received;
+};
+
+int main() {
+  VethPair veth(SEND_IFACE, RECV_IFACE);
+  if (!veth.up()) {
+    return veth.skip();
+  }
+
+  int failures = 0;
+  {
+    sem_t received;
+    sem_init(&received, 0, 0);
+    SimulatedClock clock;
+    Engine<Ethernet> sender(SEND_IFACE);
+    RecvNIC nic(RECV_IFACE, &clock);
+    Stamper stamper(&nic, &received);
+
+    int64_t before_send[NUM_FRAMES];
+    int64_t tx_time[NUM_FRAMES];
+    Buffer buf;
+    for (int seq = 0; seq < NUM_FRAMES; seq++) {
+      auto *frame = buf.template data<Ethernet::Frame>();
+      std::memcpy(frame->dst.mac, Ethernet::BROADCAST_ADDRESS, 6);
+      frame->src = sender.getAddress();
+      frame->prot = htons(PROTO);
+      std::memcpy(buf.template data<std::byte>() + SEQ_OFFSET, &seq,
+                  sizeof(seq));
+      buf.setSize(Ethernet::HEADER_SIZE + 64);
+      before_send[seq] = now_us<std::chrono::system_clock>();
+      if (sender.send_timestamped(&buf, tx_time[seq]) <= 0) {
+        std::cerr << "Falha ao enviar o quadro " << seq << std::endl;
+        failures++;
+      }
+    }
+
+    for (int i = 0; i < NUM_FRAMES; i++) {
+      struct timespec deadline;
+      clock_gettime(CLOCK_REALTIME, &deadline);
+      deadline.tv_sec += TIMEOUT_SEC;
+      if (sem_timedwait(&received, &deadline) != 0) {
+        std::cerr << "Timeout: " << i << " de " << NUM_FRAMES
+                  << " quadros recebidos" << std::endl;
+        failures++;
+        break;
+      }
+    }
+
+    int64_t sum_tx = 0;
+    int64_t sum_wakeup = 0;
+    int64_t max_wakeup = 0;
+    for (int seq = 0; seq < NUM_FRAMES; seq++) {
+      if (tx_time[seq] == 0 || tx_time[seq] < before_send[seq]) {
+        std::cerr << "Quadro " << seq << " sem timestamp de transmissão"
+                  << std::endl;
+        failures++;
+        continue;
+      }
+      int64_t rx = stamper.kernel_rx[seq];
+      if (rx == 0 || rx < tx_time[seq] ||
+          rx > stamper.handled_at[seq] ||
+          stamper.receive_time[seq] != clock.getTimestamp(rx)) {
+        std::cerr << "Quadro " << seq
+                  << " sem timestamp de recepção do kernel" << std::endl;
+        failures++;
+        continue;
+      }
+      sum_tx += tx_time[seq] - before_send[seq];
+      sum_wakeup += stamper.handled_at[seq] - rx;
+      max_wakeup = std::max(max_wakeup, stamper.handled_at[seq] - rx);
+    }
+
+    std::cout << "Média até o timestamp de transmissão: "
+              << sum_tx / NUM_FRAMES << " us" << std::endl;
+    std::cout << "Latência da thread de recepção evitada: média "
+              << sum_wakeup / NUM_FRAMES << " us, máxima " << max_wakeup
+              << " us" << std::endl;
+    sem_destroy(&received);
+  }
+
+  if (failures > 0) {
+    std::cerr << failures << " falhas" << std::endl;
+    return 1;
+  }
+  std::cout << "Timestamps do kernel OK" << std::endl;
+  return 0;
+}
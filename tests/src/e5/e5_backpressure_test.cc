@@ -0,0 +1,88 @@
+#include "nic.hh"
+#include "shared_engine.hh"
+#include "shared_mem.hh"
+#include "sync_engine.hh"
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+// Contrapressão na transmissão com um pool de envio pequeno. Acima da marca
+// alta o tráfego de massa é recusado (Drop) ou espera a folga (Block),
+// enquanto o tráfego prioritário continua recebendo buffers.
+
+constexpr unsigned int SEND_BUFFERS = 8;
+constexpr unsigned int HIGH = 6;
+constexpr unsigned int LOW = 4;
+constexpr auto TIMEOUT = std::chrono::milliseconds(50);
+
+using SharedMemNIC = NIC<SharedEngine<SharedMem>>;
+using Statistics = SharedMemNIC::Statistics;
+using namespace std::chrono;
+
+bool check(bool ok, const char *what) {
+  std::cout << what << ": " << (ok ? "OK" : "FALHOU") << std::endl;
+  return ok;
+}
+
+int main() {
+  SimulatedClock clock;
+  SharedMemNIC nic(INTERFACE_NAME, &clock, SEND_BUFFERS, SEND_BUFFERS);
+  bool ok = true;
+
+  // Buffers de envio retidos (ex.: quadros ainda na fila da Engine)
+  std::vector<Buffer *> held;
+  for (unsigned int i = 0; i < HIGH; i++) {
+    held.push_back(nic.alloc(1, Buffer::BUFFER_SIZE, TxClass::Bulk));
+  }
+
+  nic.setTxBackpressure({ HIGH, LOW, TxBackpressure::Drop, TIMEOUT });
+  ok &= check(nic.alloc(1, Buffer::BUFFER_SIZE, TxClass::Bulk) == nullptr,
+              "Massa recusada na marca alta");
+  Buffer *priority = nic.alloc(1);
+  ok &= check(priority != nullptr, "Prioritário na marca alta");
+  nic.free(priority);
+
+  // Acima da marca baixa a contenção continua
+  nic.free(held.back());
+  held.pop_back();
+  ok &= check(nic.alloc(1, Buffer::BUFFER_SIZE, TxClass::Bulk) == nullptr,
+              "Massa recusada entre as marcas");
+
+  nic.setTxBackpressure({ HIGH, LOW, TxBackpressure::Block, TIMEOUT });
+  auto begin = steady_clock::now();
+  ok &= check(nic.alloc(1, Buffer::BUFFER_SIZE, TxClass::Bulk) == nullptr &&
+                  steady_clock::now() - begin >= TIMEOUT,
+              "Massa bloqueada até o timeout");
+
+  // Outra thread devolve buffers até a marca baixa e libera o remetente
+  std::thread releaser([&nic, &held]() {
+    std::this_thread::sleep_for(milliseconds(10));
+    while (held.size() > LOW) {
+      nic.free(held.back());
+      held.pop_back();
+    }
+  });
+  begin = steady_clock::now();
+  Buffer *bulk = nic.alloc(1, Buffer::BUFFER_SIZE, TxClass::Bulk);
+  auto waited = steady_clock::now() - begin;
+  releaser.join();
+  ok &= check(bulk != nullptr && waited < TIMEOUT,
+              "Massa liberada na marca baixa");
+  nic.free(bulk);
+  for (Buffer *buf : held) {
+    nic.free(buf);
+  }
+
+  Statistics::Snapshot snap = nic.statistics();
+  std::cout << "Envios recusados: " << snap[Statistics::DROP_BACKPRESSURE]
+            << std::endl;
+  ok &= check(snap[Statistics::DROP_BACKPRESSURE] == 3,
+              "Recusas contadas");
+
+  if (!ok) {
+    return 1;
+  }
+  std::cout << "Contrapressão OK" << std::endl;
+  return 0;
+}
@@ -0,0 +1,98 @@
+#include "frame_counter.hh"
+#include "nic.hh"
+#include "shared_engine.hh"
+#include "shared_mem.hh"
+#include "sync_engine.hh"
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+// Estatísticas da NIC com várias threads enviando ao mesmo tempo pela
+// SharedEngine (cada envio é entregue à própria NIC). Confere que nenhum
+// incremento se perde e que os descartes são separados por motivo: quadros
+// de um protocolo sem observador e alocações com o pool esgotado.
+
+constexpr int THREADS = 4;
+constexpr int FRAMES_PER_THREAD = 5000;
+constexpr unsigned short OBSERVED = 0x88B5;
+constexpr unsigned short UNOBSERVED = 0x88B6;
+constexpr int FRAME_SIZE = SharedMem::HEADER_SIZE + 64;
+
+using SharedMemNIC = NIC<SharedEngine<SharedMem>>;
+using Statistics = SharedMemNIC::Statistics;
+
+// Confere um contador da cópia
+bool expect(const Statistics::Snapshot &snap, Statistics::Counter c,
+            unsigned long long expected, const char *what) {
+  std::cout << what << ": " << snap[c] << " de " << expected << std::endl;
+  if (snap[c] != expected) {
+    std::cerr << "Esperado " << expected << std::endl;
+    return false;
+  }
+  return true;
+}
+
+int main() {
+  SimulatedClock clock;
+  SharedMemNIC nic(INTERFACE_NAME, &clock);
+  FrameCount count;
+  FrameCounter<SharedMemNIC> counter(&nic, &count, OBSERVED);
+
+  // Metade dos quadros de cada thread vai para um protocolo sem observador
+  std::vector<std::thread> senders;
+  for (int t = 0; t < THREADS; t++) {
+    senders.emplace_back([&nic]() {
+      for (int i = 0; i < FRAMES_PER_THREAD; i++) {
+        Buffer *buf = nic.alloc(1, FRAME_SIZE);
+        if (buf == nullptr) {
+          i--;
+          continue;
+        }
+        buf->template data<SharedMem::Frame>()->prot =
+            i % 2 ? UNOBSERVED : OBSERVED;
+        buf->setSize(FRAME_SIZE);
+        nic.send(buf);
+      }
+    });
+  }
+  for (auto &sender : senders) {
+    sender.join();
+  }
+
+  // A entrega acontece na thread despachante da SharedEngine
+  const unsigned long long total = THREADS * FRAMES_PER_THREAD;
+  Statistics::Snapshot snap = nic.statistics();
+  for (int i = 0; i < 1000 && snap[Statistics::RX_PACKETS] < total; i++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    snap = nic.statistics();
+  }
+  bool ok = true;
+  ok &= expect(snap, Statistics::TX_PACKETS, total, "Quadros enviados");
+  ok &= expect(snap, Statistics::TX_BYTES, total * FRAME_SIZE,
+               "Bytes enviados");
+  ok &= expect(snap, Statistics::RX_PACKETS, total, "Quadros recebidos");
+  ok &= expect(snap, Statistics::DROP_NO_OBSERVER, total / 2,
+               "Descartes sem observador");
+  ok &= static_cast<unsigned long long>(count.received.load()) == total / 2;
+
+  // Esgota os pools de envio: a primeira alocação sem buffer é registrada
+  std::vector<Buffer *> held;
+  while (Buffer *buf = nic.alloc(1)) {
+    held.push_back(buf);
+  }
+  snap = nic.statistics();
+  ok &= snap[Statistics::DROP_POOL_EXHAUSTED] >= 1;
+  std::cout << "Alocações sem buffer: " << snap[Statistics::DROP_POOL_EXHAUSTED]
+            << std::endl;
+  for (Buffer *buf : held) {
+    nic.free(buf);
+  }
+
+  if (!ok) {
+    return 1;
+  }
+  std::cout << "Estatísticas da NIC OK" << std::endl;
+  return 0;
+}
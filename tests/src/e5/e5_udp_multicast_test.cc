@@ -0,0 +1,100 @@
+#include "ethernet.hh"
+#include "frame_counter.hh"
+#include "nic.hh"
+#include "sync_engine.hh"
+#include "topology.hh"
+#include "udp_multicast_engine.hh"
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+// Três NICs sobre UDP multicast, uma em cada quadrante de uma topologia 3x1.
+// Cada NIC escuta o próprio quadrante e os vizinhos: os quadros enviados no
+// quadrante 0 chegam ao quadrante 1, mas não ao 2, até que a NIC do
+// quadrante 2 passe para o quadrante 0. Quadros próprios e destinados a
+// outros sistemas são descartados pelo filtro do kernel.
+
+constexpr int NUM_FRAMES = 50;
+constexpr unsigned short PROTO = 0x88B5;
+// Mesmas posições de SysID usadas pelo protocolo
+constexpr unsigned int ORIGIN_OFFSET = Ethernet::HEADER_SIZE + 6;
+constexpr unsigned int DEST_OFFSET = ORIGIN_OFFSET + 12;
+constexpr int32_t BROADCAST_ID = 0;
+
+using UdpNIC = NIC<UdpMulticastEngine<Ethernet>>;
+
+// Envia NUM_FRAMES quadros de origin para dest pela NIC
+void send_frames(UdpNIC &nic, int32_t origin, int32_t dest) {
+  for (int i = 0; i < NUM_FRAMES; i++) {
+    Buffer *buf = nic.alloc(1);
+    if (buf == nullptr) {
+      i--;
+      continue;
+    }
+    auto *frame = buf->template data<Ethernet::Frame>();
+    std::memcpy(frame->dst.mac, Ethernet::BROADCAST_ADDRESS, 6);
+    frame->src = nic.address();
+    frame->prot = htons(PROTO);
+    std::memcpy(buf->template data<std::byte>() + ORIGIN_OFFSET, &origin,
+                sizeof(origin));
+    std::memcpy(buf->template data<std::byte>() + DEST_OFFSET, &dest,
+                sizeof(dest));
+    buf->setSize(Ethernet::HEADER_SIZE + 64);
+    nic.send(buf);
+    nic.free(buf);
+  }
+  // Tempo para a entrega pelo loop do multicast
+  std::this_thread::sleep_for(std::chrono::milliseconds(300));
+}
+
+// Confere e zera o contador
+bool expect(FrameCount &count, int expected, const char *what) {
+  int received = count.received.exchange(0);
+  std::cout << what << ": " << received << " de " << expected << std::endl;
+  if (received != expected) {
+    std::cerr << "Esperado " << expected << std::endl;
+    return false;
+  }
+  return true;
+}
+
+int main() {
+  Topology topo({ 3, 1 }, 10);
+  SimulatedClock clock;
+  UdpNIC nics[3] = { UdpNIC(INTERFACE_NAME, &clock),
+                     UdpNIC(INTERFACE_NAME, &clock),
+                     UdpNIC(INTERFACE_NAME, &clock) };
+  for (int q = 0; q < 3; q++) {
+    nics[q].filterSysID(ORIGIN_OFFSET, DEST_OFFSET, q + 1, { BROADCAST_ID });
+    nics[q].setQuadrant(q, topo.get_neighborhood(q));
+  }
+  FrameCount counts[3];
+  FrameCounter<UdpNIC> counters[3] = { { &nics[0], &counts[0], htons(PROTO) },
+                                       { &nics[1], &counts[1], htons(PROTO) },
+                                       { &nics[2], &counts[2], htons(PROTO) } };
+
+  bool ok = true;
+  send_frames(nics[0], 1, BROADCAST_ID);
+  ok &= expect(counts[0], 0, "Quadrante 0 (próprios quadros)");
+  ok &= expect(counts[1], NUM_FRAMES, "Quadrante 1 (vizinho)");
+  ok &= expect(counts[2], 0, "Quadrante 2 (não vizinho)");
+
+  send_frames(nics[2], 3, 2);
+  ok &= expect(counts[1], NUM_FRAMES, "Quadrante 1 (unicast)");
+  send_frames(nics[2], 3, 4);
+  ok &= expect(counts[1], 0, "Quadrante 1 (outro destino)");
+
+  // A NIC do quadrante 2 passa para o quadrante 0
+  nics[2].setQuadrant(0, topo.get_neighborhood(0));
+  send_frames(nics[0], 1, BROADCAST_ID);
+  ok &= expect(counts[1], NUM_FRAMES, "Quadrante 1 após a mudança");
+  ok &= expect(counts[2], NUM_FRAMES, "Nova NIC do quadrante 0");
+
+  if (!ok) {
+    return 1;
+  }
+  std::cout << "UDP multicast por quadrante OK" << std::endl;
+  return 0;
+}
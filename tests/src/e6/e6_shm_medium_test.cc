@@ -0,0 +1,232 @@
+#include "communicator.hh"
+#include "ethernet.hh"
+#include "frame_counter.hh"
+#include "message.hh"
+#include "navigator.hh"
+#include "nic.hh"
+#include "protocol.hh"
+#include "shared_engine.hh"
+#include "shared_mem.hh"
+#include "shm_medium_engine.hh"
+#include "sync_engine.hh"
+#include "topology.hh"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+// Meio de broadcast em memória compartilhada entre processos, sem root.
+// Três processos abrem o mesmo meio: cada um envia NUM_FRAMES quadros em
+// broadcast e NUM_FRAMES para o próximo processo, e deve receber os
+// broadcasts dos outros dois e os unicasts do anterior, sem os próprios.
+// O atraso de entrega é medido com o relógio monotônico, comum aos
+// processos. Por fim, duas pilhas de protocolo completas trocam mensagens
+// pelo meio, com o mesmo formato de quadro da Engine de socket raw.
+
+constexpr int NUM_PROCS = 3;
+constexpr int NUM_FRAMES = 2000;
+constexpr int NUM_MSGS = 100;
+constexpr int MSG_SIZE = 8;
+constexpr unsigned short PROTO = 0x88B5;
+// Mesmas posições de SysID usadas pelo protocolo
+constexpr unsigned int ORIGIN_OFFSET = Ethernet::HEADER_SIZE + 6;
+constexpr unsigned int DEST_OFFSET = ORIGIN_OFFSET + 12;
+constexpr unsigned int TIME_OFFSET = DEST_OFFSET + 4;
+constexpr int32_t BROADCAST_ID = 0;
+constexpr int TIMEOUT_SEC = 10;
+constexpr auto SEND_INTERVAL = std::chrono::microseconds(50);
+
+using ShmNIC = NIC<ShmMediumEngine<Ethernet>>;
+
+int64_t now_ns() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+// Conta os quadros recebidos e guarda o atraso de cada um
+class LatencyCounter : public FrameCounter<ShmNIC> {
+public:
+  LatencyCounter(ShmNIC *nic)
+      : FrameCounter<ShmNIC>(nic, &count, htons(PROTO)) {
+  }
+
+  FrameCount count;
+  std::vector<int64_t> latencies = std::vector<int64_t>(NUM_PROCS * NUM_FRAMES);
+
+protected:
+  void inspect(Buffer *buf) override {
+    int64_t sent;
+    std::memcpy(&sent, buf->template data<std::byte>() + TIME_OFFSET,
+                sizeof(sent));
+    int n = _recorded++;
+    if (n < NUM_PROCS * NUM_FRAMES) {
+      latencies[n] = now_ns() - sent;
+    }
+  }
+
+private:
+  std::atomic<int> _recorded = 0;
+};
+
+// Envia um quadro de origin para dest com o instante de envio
+void send_frame(ShmNIC &nic, int32_t origin, int32_t dest) {
+  Buffer *buf;
+  while ((buf = nic.alloc(1, Ethernet::HEADER_SIZE + 64)) == nullptr) {
+    std::this_thread::yield();
+  }
+  auto *frame = buf->template data<Ethernet::Frame>();
+  std::memcpy(frame->dst.mac, Ethernet::BROADCAST_ADDRESS, 6);
+  frame->src = nic.address();
+  frame->prot = htons(PROTO);
+  std::byte *bytes = buf->template data<std::byte>();
+  std::memcpy(bytes + ORIGIN_OFFSET, &origin, sizeof(origin));
+  std::memcpy(bytes + DEST_OFFSET, &dest, sizeof(dest));
+  int64_t sent = now_ns();
+  std::memcpy(bytes + TIME_OFFSET, &sent, sizeof(sent));
+  buf->setSize(Ethernet::HEADER_SIZE + 64);
+  nic.send(buf);
+  nic.free(buf);
+}
+
+// Processo i: SysID i + 1, unicast para o próximo processo
+int run_process(const char *medium, int i, std::atomic<int> *ready) {
+  SimulatedClock clock;
+  ShmNIC nic(medium, &clock);
+  const int32_t own = i + 1;
+  nic.filterSysID(ORIGIN_OFFSET, DEST_OFFSET, own, { BROADCAST_ID });
+  LatencyCounter counter(&nic);
+
+  // Só envia quando todos já abriram o meio
+  ready->fetch_add(1);
+  while (ready->load() < NUM_PROCS) {
+    std::this_thread::yield();
+  }
+  // Envios espaçados: um leitor uma volta atrás no anel perderia quadros
+  const int32_t next = (i + 1) % NUM_PROCS + 1;
+  for (int f = 0; f < NUM_FRAMES; f++) {
+    send_frame(nic, own, BROADCAST_ID);
+    send_frame(nic, own, next);
+    std::this_thread::sleep_for(SEND_INTERVAL);
+  }
+
+  const int expected = NUM_PROCS * NUM_FRAMES;
+  auto deadline =
+      std::chrono::steady_clock::now() + std::chrono::seconds(TIMEOUT_SEC);
+  while (counter.count.received.load() < expected &&
+         std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  // Quadros a mais chegariam logo em seguida
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+  int received = counter.count.received.load();
+  auto snap = nic.statistics();
+  std::vector<int64_t> lat(counter.latencies.begin(),
+                           counter.latencies.begin() +
+                               std::min(received, NUM_PROCS * NUM_FRAMES));
+  std::sort(lat.begin(), lat.end());
+  std::cout << "Processo " << i << ": " << received << " de " << expected
+            << " quadros, " << snap[ShmNIC::Statistics::DROP_KERNEL]
+            << " perdidos";
+  if (!lat.empty()) {
+    std::cout << ", atraso p50 " << lat[lat.size() / 2] / 1000.0
+              << " us, p99 " << lat[lat.size() * 99 / 100] / 1000.0 << " us";
+  }
+  std::cout << std::endl;
+  return received == expected ? 0 : 1;
+}
+
+// Duas pilhas de protocolo no mesmo meio trocam NUM_MSGS mensagens
+int run_protocol(const char *medium) {
+  using SharedMemNIC = NIC<SharedEngine<SharedMem>>;
+  using Protocol = Protocol<ShmNIC, SharedMemNIC, NavigatorDirected>;
+  using Message = Message<Protocol::Address, Protocol>;
+  using Communicator = Communicator<Protocol, Message>;
+
+  Topology topo({ 1, 1 }, 10);
+  NavigatorCommon::Coordinate point(0, 0);
+  Protocol prot_a(medium, getpid(), { point }, topo, 10, 0);
+  Protocol prot_b(medium, getpid() + 1, { point }, topo, 10, 0);
+  Communicator comm_a(&prot_a, 10);
+  Communicator comm_b(&prot_b, 11);
+  Protocol::Address addr_b(prot_b.getNICPAddr(), prot_b.getSysID(), 11);
+
+  int in_order = 0;
+  std::thread receiver([&]() {
+    for (int i = 0; i < NUM_MSGS; i++) {
+      Message msg(MSG_SIZE, Control(Control::Type::COMMON), &prot_b);
+      if (!comm_b.receive(&msg)) {
+        break;
+      }
+      int64_t value;
+      std::memcpy(&value, msg.data(), sizeof(value));
+      if (value == i) {
+        in_order++;
+      }
+    }
+  });
+  for (int i = 0; i < NUM_MSGS;) {
+    Message msg(comm_a.addr(), addr_b, MSG_SIZE,
+                Control(Control::Type::COMMON), &prot_a);
+    int64_t value = i;
+    std::memcpy(msg.data(), &value, sizeof(value));
+    if (comm_a.send(&msg)) {
+      i++;
+    }
+  }
+  receiver.join();
+  std::cout << "Protocolo: " << in_order << " de " << NUM_MSGS
+            << " mensagens em ordem" << std::endl;
+  return in_order == NUM_MSGS ? 0 : 1;
+}
+
+int main() {
+  // Meio exclusivo deste teste
+  std::string medium = "e6shm" + std::to_string(getpid());
+
+  auto *ready = static_cast<std::atomic<int> *>(
+      mmap(nullptr, sizeof(std::atomic<int>), PROT_READ | PROT_WRITE,
+           MAP_SHARED | MAP_ANONYMOUS, -1, 0));
+  if (ready == MAP_FAILED) {
+    perror("mmap");
+    return 1;
+  }
+  new (ready) std::atomic<int>(0);
+
+  std::vector<pid_t> children;
+  for (int i = 0; i < NUM_PROCS; i++) {
+    pid_t pid = fork();
+    if (pid == 0) {
+      _exit(run_process(medium.c_str(), i, ready));
+    }
+    children.push_back(pid);
+  }
+  int result = 0;
+  for (pid_t pid : children) {
+    int status;
+    waitpid(pid, &status, 0);
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+      result = 1;
+    }
+  }
+  ShmMediumEngine<Ethernet>::destroyMedium(medium.c_str());
+  munmap(ready, sizeof(std::atomic<int>));
+
+  medium += "p";
+  result |= run_protocol(medium.c_str());
+  ShmMediumEngine<Ethernet>::destroyMedium(medium.c_str());
+
+  if (result != 0) {
+    return 1;
+  }
+  std::cout << "Meio em memória compartilhada OK" << std::endl;
+  return 0;
+}
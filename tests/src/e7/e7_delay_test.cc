@@ -9,6 +9,7 @@
 #include "shared_mem.hh"
 #include "utils.hh"
 
+#include <algorithm>
 #include <array>
 #include <cassert>
 #include <csignal>
@@ -17,6 +18,7 @@
 #include <iostream>
 #include <sys/wait.h>
 #include <unistd.h>
+#include <vector>
 
 #ifndef INTERFACE_NAME
 #define INTERFACE_NAME "lo"
@@ -26,11 +28,30 @@ constexpr int NUM_CARS = 15;
 constexpr int MESSAGE_SIZE = 92;
 constexpr int64_t SIM_END = 30;
 
-int main() {
-  using SocketNIC = NIC<Engine<Ethernet>>;
+// Políticas de recepção comparadas pelo teste
+struct AdaptiveConfig : DefaultEngineConfig {
+  static constexpr RxPolicy RX_POLICY = RxPolicy::Adaptive;
+};
+
+struct BusyPollConfig : DefaultEngineConfig {
+  static constexpr RxPolicy RX_POLICY = RxPolicy::BusyPoll;
+};
+
+// Retorna o percentil p (0 a 100) dos delays já ordenados
+int64_t percentile(const std::vector<int64_t> &sorted, double p) {
+  if (sorted.empty()) {
+    return 0;
+  }
+  size_t idx = static_cast<size_t>(p / 100.0 * (sorted.size() - 1));
+  return sorted[idx];
+}
+
+template <typename SocketEngine>
+void run_delay() {
+  using SocketNIC = NIC<SocketEngine>;
   using SharedMemNIC = NIC<SharedEngine<SharedMem>>;
   using Protocol = Protocol<SocketNIC, SharedMemNIC, NavigatorDirected>;
-  using Message = Message<Protocol::Address, Protocol>;
+  using Message = Message<typename Protocol::Address, Protocol>;
 
   Map *map = new Map(3, 3);
 
@@ -46,6 +67,10 @@ int main() {
     PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
   int64_t *shared_shared_mem_deltas = (int64_t *)mmap(NULL, NUM_CARS * sizeof(int64_t),
     PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  int64_t *shared_socket_p99 = (int64_t *)mmap(NULL, NUM_CARS * sizeof(int64_t),
+    PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  int64_t *shared_socket_p999 = (int64_t *)mmap(NULL, NUM_CARS * sizeof(int64_t),
+    PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
   pthread_mutex_t *shared_mutex = (pthread_mutex_t *)mmap(NULL, sizeof(pthread_mutex_t),
     PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
   int64_t *max_shared = (int64_t *)mmap(NULL, sizeof(int64_t),
@@ -70,6 +95,8 @@ int main() {
   for (int i = 0; i < NUM_CARS; i++) {
     shared_socket_deltas[i] = 0;
     shared_shared_mem_deltas[i] = 0;
+    shared_socket_p99[i] = 0;
+    shared_socket_p999[i] = 0;
   }
 
   auto parent_pid = getpid();
@@ -92,7 +119,7 @@ int main() {
   }
 
   if (getpid() != parent_pid) {
-    E7Car car(dataset_id, label);
+    E7Car<SocketEngine> car(dataset_id, label);
 
     int ret = pthread_barrier_wait(barrier);
     if (ret != 0 && ret != PTHREAD_BARRIER_SERIAL_THREAD) {
@@ -113,6 +140,7 @@ int main() {
       int64_t min_sock_int = INT64_MAX;
       int64_t max_shared_int = INT64_MIN;
       int64_t min_shared_int = INT64_MAX;
+      std::vector<int64_t> socket_delays;
       while (running) {
         memset(message.data(), 0, MESSAGE_SIZE);
         if (!car.receive(&message)) {
@@ -131,6 +159,7 @@ int main() {
             shared_mem_counter++;
           } else {
             socket_delta += recv_t - send_at;
+            socket_delays.push_back(recv_t - send_at);
             if (recv_t - send_at > max_sock_int) {
               max_sock_int = recv_t - send_at;
             } else if (recv_t - send_at < min_sock_int) {
@@ -148,7 +177,12 @@ int main() {
       if (shared_mem_delta != 0) {
         mean_shared_mem_delta = shared_mem_delta / shared_mem_counter;
       }
+      std::sort(socket_delays.begin(), socket_delays.end());
       pthread_mutex_lock(shared_mutex);
+      shared_socket_p99[std::stoi(car._dataset_id)] =
+          percentile(socket_delays, 99);
+      shared_socket_p999[std::stoi(car._dataset_id)] =
+          percentile(socket_delays, 99.9);
       shared_socket_deltas[std::stoi(car._dataset_id)] = mean_socket_delta;
       shared_shared_mem_deltas[std::stoi(car._dataset_id)] = mean_shared_mem_delta;
       if (max_sock_int > *max_socket) {
@@ -193,6 +227,18 @@ int main() {
     std::cout << "Mínimo delay de envio Socket: " << *min_socket << " microseconds" << std::endl;
     std::cout << "Máximo delay de envio SharedMem: " << *max_shared << " microseconds" << std::endl;
     std::cout << "Mínimo delay de envio SharedMem: " << *min_shared << " microseconds" << std::endl;
+
+    // Latência de cauda: média entre os carros dos percentis de cada um
+    int64_t mean_socket_p99 = 0;
+    int64_t mean_socket_p999 = 0;
+    for (int i = 0; i < NUM_CARS; i++) {
+      mean_socket_p99 += shared_socket_p99[i];
+      mean_socket_p999 += shared_socket_p999[i];
+    }
+    mean_socket_p99 /= NUM_CARS;
+    mean_socket_p999 /= NUM_CARS;
+    std::cout << "Delay de envio Socket p99: " << mean_socket_p99 << " microseconds" << std::endl;
+    std::cout << "Delay de envio Socket p99.9: " << mean_socket_p999 << " microseconds" << std::endl;
     // Cleanup shared memory
     munmap(max_shared, sizeof(int64_t));
     munmap(min_shared, sizeof(int64_t));
@@ -200,9 +246,24 @@ int main() {
     munmap(min_socket, sizeof(int64_t));
     munmap(shared_socket_deltas, NUM_CARS * sizeof(int64_t));
     munmap(shared_shared_mem_deltas, NUM_CARS * sizeof(int64_t));
+    munmap(shared_socket_p99, NUM_CARS * sizeof(int64_t));
+    munmap(shared_socket_p999, NUM_CARS * sizeof(int64_t));
     munmap(shared_mutex, sizeof(pthread_mutex_t));
     munmap(barrier, sizeof(pthread_barrier_t));
   }
 
+  // Veículos não seguem para as próximas variantes
+  if (getpid() != parent_pid) {
+    exit(0);
+  }
+}
+
+int main() {
+  std::cout << "==== Política de recepção Blocking ====" << std::endl;
+  run_delay<Engine<Ethernet>>();
+  std::cout << "==== Política de recepção Adaptive ====" << std::endl;
+  run_delay<Engine<Ethernet, AdaptiveConfig>>();
+  std::cout << "==== Política de recepção BusyPoll ====" << std::endl;
+  run_delay<Engine<Ethernet, BusyPollConfig>>();
   return 0;
 }
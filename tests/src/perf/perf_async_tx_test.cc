@@ -0,0 +1,109 @@
+#include "engine.hh"
+#include "ethernet.hh"
+#include "nic.hh"
+#include "sync_engine.hh"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+using namespace std;
+using namespace std::chrono;
+
+// Compara o envio síncrono (cada remetente chama a Engine) com a
+// transmissão assíncrona da NIC (fila MPSC e thread de transmissão em
+// rajadas). Várias threads publicam quadros periodicamente, como os
+// publicadores de SmartData; mede-se o tempo que cada remetente passa no
+// envio e o atraso de cada período em relação ao agendado.
+
+constexpr int PUBLISHERS = 4;
+constexpr int FRAMES_PER_PUBLISHER = 2000;
+constexpr auto PERIOD = microseconds(500);
+constexpr size_t PAYLOAD_SIZE = 128;
+constexpr unsigned short PROTO = 0x88B5;
+
+using SocketNIC = NIC<Engine<Ethernet>>;
+
+struct Result {
+  vector<long long> send_ns;  // Tempo de cada chamada de envio
+  vector<long long> late_us;  // Atraso de cada período
+};
+
+long long percentile(vector<long long> &v, double p) {
+  sort(v.begin(), v.end());
+  return v[static_cast<size_t>(p * (v.size() - 1))];
+}
+
+Result run(bool async) {
+  SimulatedClock clock;
+  SocketNIC nic(INTERFACE_NAME, &clock);
+  if (async) {
+    nic.startAsyncTx();
+  }
+  vector<Result> results(PUBLISHERS);
+  vector<thread> publishers;
+  for (int p = 0; p < PUBLISHERS; p++) {
+    publishers.emplace_back([&nic, &results, p, async]() {
+      Result &result = results[p];
+      auto next = steady_clock::now();
+      for (int i = 0; i < FRAMES_PER_PUBLISHER; i++) {
+        next += PERIOD;
+        this_thread::sleep_until(next);
+        auto start = steady_clock::now();
+        result.late_us.push_back(
+            duration_cast<microseconds>(start - next).count());
+
+        Buffer *buf = nic.alloc(1, Ethernet::HEADER_SIZE + PAYLOAD_SIZE);
+        if (buf == nullptr) {
+          continue;
+        }
+        auto *frame = buf->template data<Ethernet::Frame>();
+        memcpy(frame->dst.mac, Ethernet::BROADCAST_ADDRESS, 6);
+        frame->src = nic.address();
+        frame->prot = htons(PROTO);
+        buf->setSize(Ethernet::HEADER_SIZE + PAYLOAD_SIZE);
+        if (async) {
+          nic.sendAsync(buf);
+        } else {
+          nic.send(buf);
+          nic.free(buf);
+        }
+        result.send_ns.push_back(
+            duration_cast<nanoseconds>(steady_clock::now() - start).count());
+      }
+    });
+  }
+  for (auto &publisher : publishers) {
+    publisher.join();
+  }
+  nic.stopAsyncTx();
+
+  auto snap = nic.statistics();
+  cout << (async ? "Assíncrono" : "Síncrono") << ": "
+       << snap[SocketNIC::Statistics::TX_PACKETS] << " quadros enviados, "
+       << snap[SocketNIC::Statistics::DROP_TX_FAILED] << " falhas" << endl;
+
+  Result all;
+  for (auto &result : results) {
+    all.send_ns.insert(all.send_ns.end(), result.send_ns.begin(),
+                       result.send_ns.end());
+    all.late_us.insert(all.late_us.end(), result.late_us.begin(),
+                       result.late_us.end());
+  }
+  return all;
+}
+
+int main() {
+  Result sync = run(false);
+  Result async = run(true);
+  cout << "Modo | envio p50 (ns) | envio p99 (ns) | atraso p99 (us)" << endl;
+  cout << "Síncrono | " << percentile(sync.send_ns, 0.5) << " | "
+       << percentile(sync.send_ns, 0.99) << " | "
+       << percentile(sync.late_us, 0.99) << endl;
+  cout << "Assíncrono | " << percentile(async.send_ns, 0.5) << " | "
+       << percentile(async.send_ns, 0.99) << " | "
+       << percentile(async.late_us, 0.99) << endl;
+  return 0;
+}
@@ -0,0 +1,142 @@
+#include "buffer.hh"
+#include "buffer_pool.hh"
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+using namespace std::chrono;
+
+// Mede a vazão de alloc/free com 1, 2, 4 e 8 threads disputando o mesmo
+// pool, comparando o BufferPool (pilha sem travas e magazines por thread)
+// com o pool anterior da NIC (trava única e busca linear por um buffer
+// livre). Cada thread mantém BATCH buffers alocados por vez, como uma thread
+// de recepção entregando rajadas, e metade dos buffers de cada rajada é
+// liberada por outra thread, como fazem os assinantes (até um limite de
+// buffers em trânsito, para não esgotar o pool).
+
+constexpr unsigned int POOL_SIZE = 1024;
+constexpr unsigned int BATCH = 32;
+constexpr long long OPS_PER_THREAD = 2000000;
+constexpr unsigned int MAX_THREADS = 8;
+// Buffers em trânsito entre todas as threads
+constexpr unsigned int MAX_IN_FLIGHT = POOL_SIZE / 4;
+
+// Pool anterior da NIC: busca linear sob uma trava
+class LockedPool {
+public:
+  LockedPool() : _buffers(POOL_SIZE) {
+  }
+
+  Buffer *alloc() {
+    std::lock_guard<std::mutex> lock(_mtx);
+    for (unsigned int j = 0; j < POOL_SIZE; ++j) {
+      unsigned int i = (_last_used + j) % POOL_SIZE;
+      if (!_buffers[i].is_in_use()) {
+        _buffers[i].mark_in_use();
+        return &_buffers[i];
+      }
+    }
+    return nullptr;
+  }
+
+  void free(Buffer *buf) {
+    std::lock_guard<std::mutex> lock(_mtx);
+    buf->mark_free();
+  }
+
+private:
+  std::mutex _mtx;
+  std::vector<Buffer> _buffers;
+  unsigned int _last_used = POOL_SIZE - 1;
+};
+
+// Caixa por onde uma thread passa buffers para a vizinha liberar
+struct Handoff {
+  std::mutex mtx;
+  std::vector<Buffer *> bufs;
+};
+
+template <typename Pool>
+double run(Pool &pool, unsigned int threads) {
+  std::vector<Handoff> handoffs(threads);
+  std::atomic<bool> start = false;
+  std::atomic<long long> allocated = 0;
+  std::vector<std::thread> workers;
+  for (unsigned int t = 0; t < threads; t++) {
+    workers.emplace_back([&, t]() {
+      Buffer *held[BATCH];
+      std::vector<Buffer *> foreign;
+      const size_t limit = MAX_IN_FLIGHT / threads;
+      long long ok = 0;
+      while (!start.load()) {
+        std::this_thread::yield();
+      }
+      for (long long done = 0; done < OPS_PER_THREAD; done += BATCH) {
+        unsigned int n = 0;
+        while (n < BATCH && (held[n] = pool.alloc()) != nullptr) {
+          n++;
+        }
+        ok += n;
+        // Metade vai para a thread vizinha; com uma thread, fica com ela
+        unsigned int keep = n;
+        if (threads > 1) {
+          Handoff &next = handoffs[(t + 1) % threads];
+          std::lock_guard<std::mutex> lock(next.mtx);
+          if (next.bufs.size() < limit) {
+            keep = n / 2;
+            next.bufs.insert(next.bufs.end(), held + keep, held + n);
+          }
+        }
+        for (unsigned int i = 0; i < keep; i++) {
+          pool.free(held[i]);
+        }
+        {
+          std::lock_guard<std::mutex> lock(handoffs[t].mtx);
+          foreign.swap(handoffs[t].bufs);
+        }
+        for (Buffer *buf : foreign) {
+          pool.free(buf);
+        }
+        foreign.clear();
+      }
+      allocated += ok;
+    });
+  }
+
+  auto begin = steady_clock::now();
+  start = true;
+  for (auto &worker : workers) {
+    worker.join();
+  }
+  // Buffers ainda em trânsito entre threads
+  for (auto &handoff : handoffs) {
+    for (Buffer *buf : handoff.bufs) {
+      pool.free(buf);
+    }
+  }
+  double seconds = duration<double>(steady_clock::now() - begin).count();
+  // Cada operação é um alloc seguido de um free
+  return allocated / seconds / 1e6;
+}
+
+int main() {
+  auto probe = BufferPool::create(POOL_SIZE, Buffer::EthernetFrame);
+  cout << "Páginas enormes (MAP_HUGETLB): "
+       << (probe->huge_pages() ? "sim" : "não (THP)") << endl;
+  cout << "Área travada (mlock): "
+       << (probe->locked() ? "sim" : "não (RLIMIT_MEMLOCK)") << endl;
+  probe.reset();
+  cout << "Threads | Trava + busca (Mops/s) | BufferPool (Mops/s)" << endl;
+  for (unsigned int threads = 1; threads <= MAX_THREADS; threads *= 2) {
+    LockedPool locked;
+    auto pool = BufferPool::create(POOL_SIZE, Buffer::EthernetFrame);
+    double locked_rate = run(locked, threads);
+    double pool_rate = run(*pool, threads);
+    cout << threads << " | " << locked_rate << " | " << pool_rate << endl;
+  }
+  return 0;
+}
@@ -0,0 +1,221 @@
+#include "engine.hh"
+#include "ethernet.hh"
+#include "frame_counter.hh"
+#include "mac.hh"
+#include "nic.hh"
+#include "sync_engine.hh"
+#include "veth.hh"
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <semaphore.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+using namespace std;
+using namespace std::chrono;
+
+// Mede a vazão de recepção da Engine com 1, 2 e 4 filas em PACKET_FANOUT.
+// Vários emissores (um SysID cada) enviam por uma ponta de um par veth e o
+// receptor verifica um MAC por quadro, como o Protocol, na outra ponta.
+// Também confere se a ordem dos quadros de cada origem foi preservada.
+
+constexpr const char *SEND_IFACE = "fanbench0";
+constexpr const char *RECV_IFACE = "fanbench1";
+constexpr int NUM_SENDERS = 4;
+constexpr unsigned int MAX_QUEUES = 4;
+constexpr long long FRAMES_PER_SENDER = 25000;
+constexpr size_t PAYLOAD_SIZE = 128;
+constexpr int IDLE_TIMEOUT_MS = 1000;
+constexpr unsigned short PROTO = 0x88B5;
+
+// Posições no quadro iguais às do FullHeader do Protocol
+constexpr unsigned int ORIGIN_SYSID_OFFSET = 20;
+constexpr unsigned int DEST_SYSID_OFFSET = 32;
+// Número de sequência do emissor, logo após os endereços
+constexpr unsigned int SEQ_OFFSET = 40;
+constexpr int32_t RECEIVER_SYSID = 1;
+constexpr int32_t FIRST_SENDER_SYSID = 100;
+
+template <unsigned int N>
+struct FanoutConfig : DefaultEngineConfig {
+  static constexpr unsigned int RX_THREADS = N;
+};
+
+// Resultado compartilhado entre o processo receptor e o pai
+struct Result {
+  FrameCount count;
+  std::atomic<long long> out_of_order;
+  std::atomic<long long> last_seq[NUM_SENDERS];
+  std::atomic<long long> per_queue[MAX_QUEUES];
+};
+
+// Verifica o MAC de cada quadro e confere a sequência da sua origem
+template <typename NICType, typename SocketEngine>
+class SequenceChecker : public FrameCounter<NICType> {
+public:
+  SequenceChecker(NICType *nic, Result *result)
+      : FrameCounter<NICType>(nic, &result->count, htons(PROTO)),
+        _result(result) {
+  }
+
+protected:
+  void inspect(Buffer *buf) override {
+    std::byte *frame = buf->template data<std::byte>();
+    std::vector<std::byte> msg(frame, frame + buf->size());
+    MAC::Tag tag = MAC::compute(_key, msg);
+    (void)tag;
+
+    int32_t origin;
+    long long seq;
+    std::memcpy(&origin, frame + ORIGIN_SYSID_OFFSET, sizeof(origin));
+    std::memcpy(&seq, frame + SEQ_OFFSET, sizeof(seq));
+    int sender = origin - FIRST_SENDER_SYSID;
+    if (sender >= 0 && sender < NUM_SENDERS) {
+      if (_result->last_seq[sender].exchange(seq) > seq) {
+        _result->out_of_order.fetch_add(1);
+      }
+    }
+    _result->per_queue[SocketEngine::rxQueue()].fetch_add(1);
+  }
+
+private:
+  Result *_result;
+  MAC::Key _key{};
+};
+
+void send_frames(int sender) {
+  using SendNIC = NIC<Engine<Ethernet>>;
+  SimulatedClock clock;
+  SendNIC nic(SEND_IFACE, &clock);
+  Ethernet::Address src = nic.address();
+  int32_t origin = FIRST_SENDER_SYSID + sender;
+  int32_t dest = 0;
+  long long seq = 0;
+  while (seq < FRAMES_PER_SENDER) {
+    Buffer *buf = nic.alloc(1);
+    if (buf == nullptr) {
+      continue;
+    }
+    auto *frame = buf->template data<Ethernet::Frame>();
+    std::memcpy(frame->dst.mac, Ethernet::BROADCAST_ADDRESS, 6);
+    frame->src = src;
+    frame->prot = htons(PROTO);
+    std::byte *raw = buf->template data<std::byte>();
+    std::memset(raw + Ethernet::HEADER_SIZE, 0xAB, PAYLOAD_SIZE);
+    std::memcpy(raw + ORIGIN_SYSID_OFFSET, &origin, sizeof(origin));
+    std::memcpy(raw + DEST_SYSID_OFFSET, &dest, sizeof(dest));
+    std::memcpy(raw + SEQ_OFFSET, &seq, sizeof(seq));
+    buf->setSize(Ethernet::HEADER_SIZE + PAYLOAD_SIZE);
+    if (nic.send(buf) > 0) {
+      seq++;
+    }
+    nic.free(buf);
+  }
+}
+
+template <unsigned int N>
+void run_variant() {
+  static_assert(N <= MAX_QUEUES);
+  using BenchEngine = Engine<Ethernet, FanoutConfig<N>>;
+  using BenchNIC = NIC<BenchEngine>;
+
+  Result *result = static_cast<Result *>(mmap(NULL, sizeof(Result),
+                                              PROT_READ | PROT_WRITE,
+                                              MAP_SHARED | MAP_ANONYMOUS, -1, 0));
+  sem_t *ready = static_cast<sem_t *>(mmap(NULL, sizeof(sem_t),
+                                           PROT_READ | PROT_WRITE,
+                                           MAP_SHARED | MAP_ANONYMOUS, -1, 0));
+  if (result == MAP_FAILED || ready == MAP_FAILED) {
+    cerr << "Erro ao criar memória compartilhada." << endl;
+    exit(1);
+  }
+  new (result) Result{};
+  for (int i = 0; i < NUM_SENDERS; i++) {
+    result->last_seq[i].store(-1);
+  }
+  sem_init(ready, 1, 0);
+
+  cout << "==== " << N << " thread(s) de recepção ====" << endl;
+
+  pid_t receiver = fork();
+  if (receiver < 0) {
+    cerr << "Erro ao criar processo" << endl;
+    exit(1);
+  }
+  if (receiver == 0) {
+    SimulatedClock clock;
+    BenchNIC nic(RECV_IFACE, &clock);
+    nic.filterSysID(ORIGIN_SYSID_OFFSET, DEST_SYSID_OFFSET, RECEIVER_SYSID,
+                    { 0, -2 });
+    SequenceChecker<BenchNIC, BenchEngine> counter(&nic, result);
+    sem_post(ready);
+
+    // Termina após IDLE_TIMEOUT_MS sem novos quadros
+    long long last = -1;
+    while (true) {
+      this_thread::sleep_for(milliseconds(IDLE_TIMEOUT_MS));
+      long long received = result->count.received.load();
+      if (received == last || received >= NUM_SENDERS * FRAMES_PER_SENDER) {
+        break;
+      }
+      last = received;
+    }
+    exit(0);
+  }
+
+  sem_wait(ready);
+
+  pid_t senders[NUM_SENDERS];
+  for (int i = 0; i < NUM_SENDERS; i++) {
+    senders[i] = fork();
+    if (senders[i] < 0) {
+      cerr << "Erro ao criar processo" << endl;
+      exit(1);
+    }
+    if (senders[i] == 0) {
+      send_frames(i);
+      exit(0);
+    }
+  }
+
+  for (int i = 0; i < NUM_SENDERS; i++) {
+    waitpid(senders[i], nullptr, 0);
+  }
+  waitpid(receiver, nullptr, 0);
+
+  long long total = NUM_SENDERS * FRAMES_PER_SENDER;
+  long long received = result->count.received.load();
+  cout << "Recebidos: " << received << " de " << total << " ("
+       << (total - received) << " perdidos)" << endl;
+  cout << "Fora de ordem: " << result->out_of_order.load() << endl;
+  cout << "Quadros por fila:";
+  for (unsigned int q = 0; q < N; q++) {
+    cout << " " << result->per_queue[q].load();
+  }
+  cout << endl;
+  if (result->count.rate() > 0) {
+    cout << "Vazão de recepção: " << result->count.rate() << " quadros/s"
+         << endl;
+  }
+
+  sem_destroy(ready);
+  munmap(ready, sizeof(sem_t));
+  munmap(result, sizeof(Result));
+}
+
+int main() {
+  VethPair veth(SEND_IFACE, RECV_IFACE);
+  if (!veth.up()) {
+    return veth.skip();
+  }
+
+  cout << "CPUs disponíveis: " << sysconf(_SC_NPROCESSORS_ONLN) << endl;
+  run_variant<1>();
+  run_variant<2>();
+  run_variant<4>();
+  return 0;
+}
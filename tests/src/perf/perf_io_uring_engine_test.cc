@@ -0,0 +1,12 @@
+#include "engine_bench.hh"
+#include "io_uring_engine.hh"
+
+// Compara a vazão da Engine de socket raw com a IoUringEngine (recv
+// multishot com buffers fornecidos e envio assíncrono de buffers fixos) em um
+// par veth criado pelo próprio teste: o envio acontece em uma ponta e a
+// recepção na outra.
+
+int main() {
+  return EngineBench::compare_with_raw_socket<IoUringEngine<Ethernet>>(
+      "IoUringEngine (io_uring)", "uringbench0", "uringbench1");
+}
@@ -0,0 +1,113 @@
+#include "communicator.hh"
+#include "engine.hh"
+#include "message.hh"
+#include "navigator.hh"
+#include "nic.hh"
+#include "protocol.hh"
+#include "shared_engine.hh"
+#include "shared_mem.hh"
+#include "topology.hh"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace std;
+using namespace std::chrono;
+
+// Mede a comunicação entre componentes do mesmo carro (SysID de destino
+// igual ao próprio): ida e volta de uma mensagem entre dois Communicators
+// e vazão de um remetente para um receptor. Confere também que uma
+// mensagem para a porta BROADCAST chega a todos os Communicators.
+
+constexpr int ROUND_TRIPS = 20000;
+constexpr int STREAM_MSGS = 200000;
+constexpr int MSG_SIZE = 8;
+
+using SocketNIC = NIC<Engine<Ethernet>>;
+using SharedMemNIC = NIC<SharedEngine<SharedMem>>;
+using Proto = Protocol<SocketNIC, SharedMemNIC, NavigatorDirected>;
+using Msg = Message<Proto::Address, Proto>;
+using Comm = Communicator<Proto, Msg>;
+
+// Envia um inteiro de from para to, tentando de novo sem buffer livre
+void send_value(Comm &from, Proto &prot, Proto::Address to, int64_t value) {
+  Msg msg(from.addr(), to, MSG_SIZE, Control(Control::Type::COMMON), &prot);
+  std::memcpy(msg.data(), &value, sizeof(value));
+  while (!from.send(&msg)) {
+    this_thread::yield();
+  }
+}
+
+int64_t receive_value(Comm &comm, Proto &prot) {
+  Msg msg(MSG_SIZE, Control(Control::Type::COMMON), &prot);
+  if (!comm.receive(&msg)) {
+    return -1;
+  }
+  int64_t value;
+  std::memcpy(&value, msg.data(), sizeof(value));
+  return value;
+}
+
+int main() {
+  Topology topo({ 1, 1 }, 10);
+  NavigatorCommon::Coordinate point(0, 0);
+  Proto prot(INTERFACE_NAME, getpid(), { point }, topo, 10, 0);
+  Comm comm_a(&prot, 10);
+  Comm comm_b(&prot, 11);
+
+  // Ida e volta: B devolve cada mensagem para A
+  vector<long long> rtt_ns;
+  rtt_ns.reserve(ROUND_TRIPS);
+  thread echo([&]() {
+    for (int i = 0; i < ROUND_TRIPS; i++) {
+      send_value(comm_b, prot, comm_a.addr(), receive_value(comm_b, prot));
+    }
+  });
+  for (int i = 0; i < ROUND_TRIPS; i++) {
+    auto start = steady_clock::now();
+    send_value(comm_a, prot, comm_b.addr(), i);
+    receive_value(comm_a, prot);
+    rtt_ns.push_back(duration_cast<nanoseconds>(steady_clock::now() - start)
+                         .count());
+  }
+  echo.join();
+  sort(rtt_ns.begin(), rtt_ns.end());
+  cout << "Ida e volta: p50 " << rtt_ns[rtt_ns.size() / 2] / 1000.0
+       << " us, p99 " << rtt_ns[rtt_ns.size() * 99 / 100] / 1000.0 << " us"
+       << endl;
+
+  // Vazão: A envia sem esperar, B consome
+  int in_order = 0;
+  thread consumer([&]() {
+    for (int i = 0; i < STREAM_MSGS; i++) {
+      if (receive_value(comm_b, prot) == i) {
+        in_order++;
+      }
+    }
+  });
+  auto begin = steady_clock::now();
+  for (int i = 0; i < STREAM_MSGS; i++) {
+    send_value(comm_a, prot, comm_b.addr(), i);
+  }
+  consumer.join();
+  double seconds = duration<double>(steady_clock::now() - begin).count();
+  cout << "Vazão: " << STREAM_MSGS / seconds / 1e6 << " Mmsg/s, " << in_order
+       << " de " << STREAM_MSGS << " em ordem" << endl;
+
+  // Porta BROADCAST do próprio sistema: uma cópia para cada Communicator
+  Proto::Address bcast = prot.getInnerBroadcastAddr();
+  send_value(comm_a, prot, bcast, 42);
+  bool ok = in_order == STREAM_MSGS;
+  ok &= receive_value(comm_a, prot) == 42;
+  ok &= receive_value(comm_b, prot) == 42;
+  if (!ok) {
+    cerr << "Entrega local incorreta" << endl;
+    return 1;
+  }
+  cout << "Entrega local OK" << endl;
+  return 0;
+}
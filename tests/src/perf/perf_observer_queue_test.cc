@@ -0,0 +1,153 @@
+#include "concurrent_observer.hh"
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <queue>
+#include <semaphore>
+#include <span>
+#include <thread>
+#include <vector>
+
+using namespace std;
+using namespace std::chrono;
+
+// Mede a vazão da fila de um observador (ex.: Communicator) com 1 e 4
+// produtores e um consumidor, comparando a fila anterior (std::queue sob
+// trava e semáforo a cada dado) com a fila limitada sem travas, retirando
+// um dado por vez (updated) ou todos os disponíveis (updated_batch).
+// Confere também as duas políticas de descarte com a fila cheia.
+
+constexpr int ITEMS_PER_PRODUCER = 500000;
+constexpr unsigned int MAX_PRODUCERS = 4;
+constexpr size_t BATCH = 64;
+constexpr size_t SMALL_QUEUE = 8;
+// Comporta todos os dados da medição, sem descartes
+constexpr size_t BENCH_QUEUE = MAX_PRODUCERS * ITEMS_PER_PRODUCER;
+
+using Observer = Concurrent_Observer<int, int>;
+
+// Fila anterior
+class LockedObserver {
+public:
+  void update(int, int *d) {
+    {
+      std::lock_guard<std::mutex> lock(_mtx);
+      _data.push(d);
+    }
+    _semaphore.release();
+  }
+
+  int *updated() {
+    _semaphore.acquire();
+    std::lock_guard<std::mutex> lock(_mtx);
+    int *datum = _data.front();
+    _data.pop();
+    return datum;
+  }
+
+private:
+  std::counting_semaphore<> _semaphore{ 0 };
+  std::queue<int *> _data;
+  std::mutex _mtx;
+};
+
+// Conta os dados descartados
+class Counting : public Observer {
+public:
+  Counting(size_t capacity, Overflow overflow) : Observer(capacity, overflow) {
+  }
+
+  std::vector<int *> discarded;
+
+protected:
+  void discard(int *d) override {
+    discarded.push_back(d);
+  }
+};
+
+template <typename Queue, typename Consume>
+double run(Queue &queue, unsigned int producers, Consume consume) {
+  int datum = 0;
+  const long long total =
+      static_cast<long long>(producers) * ITEMS_PER_PRODUCER;
+  auto begin = steady_clock::now();
+  vector<thread> threads;
+  for (unsigned int p = 0; p < producers; p++) {
+    threads.emplace_back([&]() {
+      for (int i = 0; i < ITEMS_PER_PRODUCER; i++) {
+        queue.update(0, &datum);
+      }
+    });
+  }
+  long long received = 0;
+  while (received < total) {
+    received += consume(queue);
+  }
+  for (auto &t : threads) {
+    t.join();
+  }
+  double seconds = duration<double>(steady_clock::now() - begin).count();
+  return total / seconds / 1e6;
+}
+
+// Com a fila cheia, DropNewest descarta o dado que chega e DropOldest o
+// mais antigo da fila
+bool overflow_policies() {
+  int items[SMALL_QUEUE + 2];
+  bool ok = true;
+  for (auto policy : { Observer::DropNewest, Observer::DropOldest }) {
+    Counting obs(SMALL_QUEUE, policy);
+    for (int &item : items) {
+      obs.update(0, &item);
+    }
+    int *out[SMALL_QUEUE + 2];
+    size_t n = obs.updated_batch(std::span<int *>(out, SMALL_QUEUE + 2));
+    // A fila guarda SMALL_QUEUE dados; os dois restantes vão para discard
+    int *first = policy == Observer::DropNewest ? &items[0] : &items[2];
+    int *lost = policy == Observer::DropNewest ? &items[SMALL_QUEUE] : &items[0];
+    ok &= n == SMALL_QUEUE && out[0] == first && obs.dropped() == 2 &&
+          obs.discarded.size() == 2 && obs.discarded[0] == lost;
+    cout << (policy == Observer::DropNewest ? "DropNewest" : "DropOldest")
+         << ": " << n << " na fila, " << obs.dropped() << " descartados"
+         << endl;
+  }
+  return ok;
+}
+
+int main() {
+  cout << "Produtores | Trava + semáforo (M/s) | Sem travas (M/s) | "
+          "Sem travas, em lote (M/s)"
+       << endl;
+  for (unsigned int producers = 1; producers <= MAX_PRODUCERS;
+       producers *= 4) {
+    LockedObserver locked;
+    double locked_rate = run(locked, producers, [](LockedObserver &q) {
+      q.updated();
+      return 1;
+    });
+    Observer single(BENCH_QUEUE);
+    double single_rate = run(single, producers, [](Observer &q) {
+      q.updated();
+      return 1;
+    });
+    Observer batched(BENCH_QUEUE);
+    double batch_rate = run(batched, producers, [](Observer &q) {
+      int *out[BATCH];
+      return static_cast<int>(q.updated_batch(std::span<int *>(out, BATCH)));
+    });
+    if (single.dropped() + batched.dropped() > 0) {
+      cerr << "Descartes durante a medição" << endl;
+      return 1;
+    }
+    cout << producers << " | " << locked_rate << " | " << single_rate << " | "
+         << batch_rate << endl;
+  }
+
+  if (!overflow_policies()) {
+    cerr << "Política de descarte incorreta" << endl;
+    return 1;
+  }
+  cout << "Fila do observador OK" << endl;
+  return 0;
+}
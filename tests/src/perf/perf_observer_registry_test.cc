@@ -0,0 +1,248 @@
+#include "concurrent_observed.hh"
+#include "concurrent_observer.hh"
+#include "ordered_list.hh"
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+using namespace std::chrono;
+
+// Mede o custo de notify com 1 a 1024 observadores (um por porta, como os
+// Communicators) e 1 ou 4 threads notificando ao mesmo tempo, comparando o
+// Observed anterior (trava + busca linear na lista ordenada) com o registro
+// RCU indexado por condição. Confere também que detach, com notificações
+// em andamento, impede novas entregas ao observador removido, inclusive
+// quando chamado dentro de uma notificação, e que um observador pode se
+// remover em update() enquanto outra thread altera o registro.
+
+constexpr int NOTIFICATIONS = 400000;
+constexpr unsigned int MAX_OBSERVERS = 1024;
+constexpr unsigned int MAX_THREADS = 4;
+
+using Port = unsigned short;
+using Observer = Concurrent_Observer<int, Port>;
+
+// Observed anterior
+class LockedObserved {
+public:
+  void attach(Observer *o, Port c) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _observers.insert(o, c);
+  }
+
+  void detach(Observer *o, Port c) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _observers.remove(o, c);
+  }
+
+  bool notify(Port c, int *d) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    bool notified = false;
+    for (auto obs = _observers.begin(); obs != _observers.end(); ++obs) {
+      if (obs->rank() == c) {
+        obs->value()->update(c, d);
+        notified = true;
+      }
+    }
+    return notified;
+  }
+
+private:
+  Ordered_List<Observer *, Port> _observers;
+  std::mutex _mutex;
+};
+
+// Só conta as entregas, para medir apenas o despacho
+class Counter : public Observer {
+public:
+  void update(Port c, int *d) override {
+    (void)c;
+    (void)d;
+    received.fetch_add(1, memory_order_relaxed);
+  }
+
+  std::atomic<long long> received = 0;
+};
+
+template <typename Observed>
+double run(unsigned int observers, unsigned int threads) {
+  Observed observed;
+  vector<Counter> counters(observers);
+  for (unsigned int i = 0; i < observers; i++) {
+    observed.attach(&counters[i], static_cast<Port>(i));
+  }
+  int datum = 0;
+  vector<thread> notifiers;
+  auto begin = steady_clock::now();
+  for (unsigned int t = 0; t < threads; t++) {
+    notifiers.emplace_back([&, t]() {
+      for (int i = 0; i < NOTIFICATIONS; i++) {
+        observed.notify(static_cast<Port>((i + t) % observers), &datum);
+      }
+    });
+  }
+  for (auto &n : notifiers) {
+    n.join();
+  }
+  double seconds = duration<double>(steady_clock::now() - begin).count();
+  for (unsigned int i = 0; i < observers; i++) {
+    observed.detach(&counters[i], static_cast<Port>(i));
+  }
+  return threads * NOTIFICATIONS / seconds / 1e6;
+}
+
+// Depois de detach, nenhuma thread entrega mais ao observador removido
+bool detach_is_final() {
+  Concurrent_Observed<int, Port> observed;
+  Counter stay, leave;
+  observed.attach(&stay, 1);
+  observed.attach(&leave, 1);
+  std::atomic<bool> running = true;
+  int datum = 0;
+  vector<thread> notifiers;
+  for (unsigned int t = 0; t < MAX_THREADS; t++) {
+    notifiers.emplace_back([&]() {
+      while (running.load()) {
+        observed.notify(1, &datum);
+      }
+    });
+  }
+  this_thread::sleep_for(milliseconds(20));
+  observed.detach(&leave, 1);
+  long long after_detach = leave.received.load();
+  this_thread::sleep_for(milliseconds(20));
+  running = false;
+  for (auto &n : notifiers) {
+    n.join();
+  }
+  return leave.received.load() == after_detach && stay.received.load() > 0;
+}
+
+// Remove-se na primeira entrega
+class SelfRemover : public Observer {
+public:
+  SelfRemover(Concurrent_Observed<int, Port> *observed) : _observed(observed) {
+  }
+
+  void update(Port c, int *d) override {
+    (void)d;
+    received.fetch_add(1, memory_order_relaxed);
+    _observed->detach(this, c);
+  }
+
+  std::atomic<long long> received = 0;
+
+private:
+  Concurrent_Observed<int, Port> *_observed;
+};
+
+// Um observador que se remove dentro da notificação não espera por si
+// mesmo nem pelo escritor que espera por ele, e não recebe mais nada
+// depois que a notificação termina
+bool self_detach_is_deferred() {
+  Concurrent_Observed<int, Port> observed;
+  Counter other;
+  std::atomic<bool> running = true;
+  thread writer([&]() {
+    while (running.load()) {
+      observed.attach(&other, 2);
+      observed.detach(&other, 2);
+    }
+  });
+  int datum = 0;
+  bool ok = true;
+  for (int i = 0; i < 1000 && ok; i++) {
+    SelfRemover remover(&observed);
+    observed.attach(&remover, 1);
+    observed.notify(1, &datum);
+    observed.notify(1, &datum);
+    ok = remover.received.load() == 1;
+  }
+  running = false;
+  writer.join();
+  return ok;
+}
+
+// Chama detach de outro registro dentro de uma notificação
+class CrossDetacher : public Observer {
+public:
+  CrossDetacher(Concurrent_Observed<int, Port> *other, Counter *leave)
+      : _other(other), _leave(leave) {
+  }
+
+  void update(Port c, int *d) override {
+    (void)c;
+    (void)d;
+    _other->detach(_leave, 1);
+    after_detach = _leave->received.load();
+  }
+
+  long long after_detach = -1;
+
+private:
+  Concurrent_Observed<int, Port> *_other;
+  Counter *_leave;
+};
+
+// Uma leitura aberta em um registro não dispensa a espera de detach em
+// outro: a entrega ao removido termina antes de detach retornar
+bool cross_detach_is_final() {
+  Concurrent_Observed<int, Port> outer, other;
+  Counter leave;
+  CrossDetacher detacher(&other, &leave);
+  outer.attach(&detacher, 1);
+  other.attach(&leave, 1);
+  std::atomic<bool> running = true;
+  int datum = 0;
+  vector<thread> notifiers;
+  for (unsigned int t = 0; t < MAX_THREADS; t++) {
+    notifiers.emplace_back([&]() {
+      while (running.load()) {
+        other.notify(1, &datum);
+      }
+    });
+  }
+  this_thread::sleep_for(milliseconds(20));
+  outer.notify(1, &datum);
+  this_thread::sleep_for(milliseconds(20));
+  running = false;
+  for (auto &n : notifiers) {
+    n.join();
+  }
+  outer.detach(&detacher, 1);
+  return leave.received.load() == detacher.after_detach &&
+         detacher.after_detach > 0;
+}
+
+int main() {
+  cout << "Observadores | Threads | Trava + lista (Mnotif/s) | RCU (Mnotif/s)"
+       << endl;
+  for (unsigned int observers = 1; observers <= MAX_OBSERVERS;
+       observers *= 32) {
+    for (unsigned int threads = 1; threads <= MAX_THREADS; threads *= 4) {
+      double locked = run<LockedObserved>(observers, threads);
+      double rcu = run<Concurrent_Observed<int, Port>>(observers, threads);
+      cout << observers << " | " << threads << " | " << locked << " | " << rcu
+           << endl;
+    }
+  }
+
+  if (!detach_is_final()) {
+    cerr << "Entrega após detach" << endl;
+    return 1;
+  }
+  if (!self_detach_is_deferred()) {
+    cerr << "Entrega após o observador se remover" << endl;
+    return 1;
+  }
+  if (!cross_detach_is_final()) {
+    cerr << "Entrega após detach dentro de uma notificação" << endl;
+    return 1;
+  }
+  cout << "Registro de observadores OK" << endl;
+  return 0;
+}
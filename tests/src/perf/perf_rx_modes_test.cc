@@ -0,0 +1,44 @@
+#include "engine_bench.hh"
+
+// Compara a vazão da Engine de socket raw em cada modo de recepção e
+// transmissão configurável: um quadro por recvfrom, rajadas de recvmmsg
+// (padrão), o anel PACKET_RX_RING e os anéis PACKET_RX_RING e
+// PACKET_TX_RING juntos. O envio acontece em uma ponta de um par veth criado
+// pelo próprio teste e a recepção na outra. A recepção por várias filas em
+// PACKET_FANOUT é medida pelo perf_fanout_test.
+
+constexpr const char *SEND_IFACE = "rxbench0";
+constexpr const char *RECV_IFACE = "rxbench1";
+
+// Recepção de um quadro por chamada (recvfrom), para comparar com as
+// rajadas de recvmmsg da configuração padrão
+struct RecvfromConfig : DefaultEngineConfig {
+  static constexpr unsigned int RX_BURST = 1;
+};
+
+// Recepção pelo anel PACKET_RX_RING, para comparar com o socket padrão
+struct RxRingConfig : DefaultEngineConfig {
+  static constexpr bool RX_RING = true;
+};
+
+// Recepção e transmissão pelos anéis mapeados em memória
+struct RxTxRingConfig : RxRingConfig {
+  static constexpr bool TX_RING = true;
+};
+
+int main() {
+  VethPair veth(SEND_IFACE, RECV_IFACE);
+  if (!veth.up()) {
+    return veth.skip();
+  }
+  bool ok = true;
+  ok &= EngineBench::run<Engine<Ethernet, RecvfromConfig>>(
+      "Engine (recvfrom)", SEND_IFACE, RECV_IFACE);
+  ok &= EngineBench::run<Engine<Ethernet>>("Engine (recvmmsg)", SEND_IFACE,
+                                           RECV_IFACE);
+  ok &= EngineBench::run<Engine<Ethernet, RxRingConfig>>(
+      "Engine (PACKET_RX_RING)", SEND_IFACE, RECV_IFACE);
+  ok &= EngineBench::run<Engine<Ethernet, RxTxRingConfig>>(
+      "Engine (PACKET_RX_RING + PACKET_TX_RING)", SEND_IFACE, RECV_IFACE);
+  return ok ? 0 : 1;
+}
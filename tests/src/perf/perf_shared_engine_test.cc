@@ -0,0 +1,126 @@
+#include "frame_counter.hh"
+#include "nic.hh"
+#include "shared_engine.hh"
+#include "shared_mem.hh"
+#include "sync_engine.hh"
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <semaphore>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+using namespace std::chrono;
+
+// Mede a vazão da comunicação dentro do processo com 1, 2, 4 e 8
+// componentes enviando ao mesmo tempo, comparando a SharedEngine (fila
+// MPSC e thread despachante) com a anterior, que guardava o buffer em uma
+// tabela hash por thread sob um semáforo e entregava na thread do
+// remetente.
+
+constexpr unsigned int MAX_SENDERS = 8;
+constexpr int MESSAGES_PER_SENDER = 50000;
+constexpr unsigned short PROTO = 0x88B5;
+constexpr int FRAME_SIZE = SharedMem::HEADER_SIZE + 64;
+
+// SharedEngine anterior
+template <typename DataWrapper>
+class MapSharedEngine {
+public:
+  using FrameClass = DataWrapper;
+
+  MapSharedEngine(const char *) {
+  }
+
+  int send(Buffer *buf) {
+    buffer_sem.acquire();
+    unm_buf[std::this_thread::get_id()] = buf;
+    buffer_sem.release();
+    int ret = buf->size();
+    _handler(_obj);
+    return ret;
+  }
+
+  int receive(Buffer *&buf) {
+    int ret = -1;
+    buffer_sem.acquire();
+    auto it = unm_buf.find(std::this_thread::get_id());
+    if (it != unm_buf.end()) {
+      buf = it->second;
+      ret = buf->size();
+      unm_buf.erase(it);
+    }
+    buffer_sem.release();
+    return ret;
+  }
+
+  const Ethernet::Address &getAddress() {
+    return Ethernet::ZERO;
+  }
+
+  template <typename T, void (T::*handle_signal)()>
+  void bind(T *obj) {
+    _obj = obj;
+    _handler = [](void *o) { (static_cast<T *>(o)->*handle_signal)(); };
+  }
+
+private:
+  std::binary_semaphore buffer_sem{ 1 };
+  std::unordered_map<std::thread::id, Buffer *> unm_buf;
+  void *_obj = nullptr;
+  void (*_handler)(void *) = nullptr;
+};
+
+template <typename SharedNIC>
+double run(unsigned int senders) {
+  SimulatedClock clock;
+  SharedNIC nic("shared", &clock);
+  FrameCount count;
+  FrameCounter<SharedNIC> counter(&nic, &count, PROTO);
+  std::atomic<bool> start = false;
+  vector<thread> threads;
+  for (unsigned int s = 0; s < senders; s++) {
+    threads.emplace_back([&]() {
+      while (!start.load()) {
+        this_thread::yield();
+      }
+      for (int i = 0; i < MESSAGES_PER_SENDER; i++) {
+        Buffer *buf = nic.alloc(1, FRAME_SIZE);
+        if (buf == nullptr) {
+          // Buffers ainda com o despachante
+          this_thread::yield();
+          i--;
+          continue;
+        }
+        buf->template data<SharedMem::Frame>()->prot = PROTO;
+        buf->setSize(FRAME_SIZE);
+        nic.send(buf);
+      }
+    });
+  }
+
+  const long long total = static_cast<long long>(senders) * MESSAGES_PER_SENDER;
+  auto begin = steady_clock::now();
+  start = true;
+  for (auto &t : threads) {
+    t.join();
+  }
+  while (count.received.load() < total) {
+    this_thread::yield();
+  }
+  double seconds = duration<double>(steady_clock::now() - begin).count();
+  return total / seconds / 1e6;
+}
+
+int main() {
+  cout << "Remetentes | Tabela + semáforo (Mmsg/s) | Fila MPSC (Mmsg/s)"
+       << endl;
+  for (unsigned int senders = 1; senders <= MAX_SENDERS; senders *= 2) {
+    double map_rate = run<NIC<MapSharedEngine<SharedMem>>>(senders);
+    double queue_rate = run<NIC<SharedEngine<SharedMem>>>(senders);
+    cout << senders << " | " << map_rate << " | " << queue_rate << endl;
+  }
+  return 0;
+}
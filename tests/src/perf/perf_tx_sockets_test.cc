@@ -0,0 +1,110 @@
+#include "engine.hh"
+#include "ethernet.hh"
+#include "nic.hh"
+#include "sync_engine.hh"
+#include "veth.hh"
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace std;
+using namespace std::chrono;
+
+// Mede a vazão de NIC::send com 1, 2 e 4 threads publicando ao mesmo tempo,
+// com todas compartilhando o socket raw da Engine e com um socket de
+// transmissão por thread (Config::PER_THREAD_TX). Os quadros saem por uma
+// ponta de um par veth criado pelo próprio teste. Como no Protocol, o
+// filtro de SysID descarta no kernel os quadros do próprio sistema, que o
+// socket de recepção passa a ver quando o envio sai por outro socket.
+
+constexpr const char *SEND_IFACE = "txbench0";
+constexpr const char *PEER_IFACE = "txbench1";
+constexpr unsigned int MAX_THREADS = 4;
+constexpr long long FRAMES_PER_THREAD = 50000;
+constexpr size_t PAYLOAD_SIZE = 128;
+constexpr unsigned short PROTO = 0x88B5;
+// Posições no quadro iguais às do FullHeader do Protocol
+constexpr unsigned int ORIGIN_SYSID_OFFSET = 20;
+constexpr unsigned int DEST_SYSID_OFFSET = 32;
+constexpr int32_t OWN_SYSID = 1;
+constexpr int32_t BROADCAST_SYSID = 0;
+
+struct PerThreadTxConfig : DefaultEngineConfig {
+  static constexpr bool PER_THREAD_TX = true;
+};
+
+template <typename SocketNIC>
+double run(unsigned int threads) {
+  SimulatedClock clock;
+  SocketNIC nic(SEND_IFACE, &clock);
+  nic.filterSysID(ORIGIN_SYSID_OFFSET, DEST_SYSID_OFFSET, OWN_SYSID,
+                  { BROADCAST_SYSID });
+  std::atomic<bool> start = false;
+  std::atomic<long long> retries = 0;
+  vector<thread> senders;
+  for (unsigned int t = 0; t < threads; t++) {
+    senders.emplace_back([&]() {
+      long long again = 0;
+      while (!start.load()) {
+        this_thread::yield();
+      }
+      for (long long i = 0; i < FRAMES_PER_THREAD; i++) {
+        Buffer *buf = nic.alloc(1, Ethernet::HEADER_SIZE + PAYLOAD_SIZE);
+        if (buf == nullptr) {
+          i--;
+          continue;
+        }
+        auto *frame = buf->template data<Ethernet::Frame>();
+        memcpy(frame->dst.mac, Ethernet::BROADCAST_ADDRESS, 6);
+        frame->src = nic.address();
+        frame->prot = htons(PROTO);
+        std::byte *bytes = buf->template data<std::byte>();
+        memcpy(bytes + ORIGIN_SYSID_OFFSET, &OWN_SYSID, sizeof(OWN_SYSID));
+        memcpy(bytes + DEST_SYSID_OFFSET, &BROADCAST_SYSID,
+               sizeof(BROADCAST_SYSID));
+        buf->setSize(Ethernet::HEADER_SIZE + PAYLOAD_SIZE);
+        // Socket cheio: tenta de novo para medir apenas quadros enviados
+        while (nic.send(buf) <= 0) {
+          again++;
+          this_thread::yield();
+        }
+        nic.free(buf);
+      }
+      retries += again;
+    });
+  }
+
+  auto begin = steady_clock::now();
+  start = true;
+  for (auto &sender : senders) {
+    sender.join();
+  }
+  double seconds = duration<double>(steady_clock::now() - begin).count();
+  if (retries > 0) {
+    cout << "  (" << retries << " reenvios com o socket cheio)" << endl;
+  }
+  return threads * FRAMES_PER_THREAD / seconds;
+}
+
+int main() {
+  VethPair veth(SEND_IFACE, PEER_IFACE);
+  if (!veth.up()) {
+    return veth.skip();
+  }
+
+  cout << "CPUs disponíveis: " << sysconf(_SC_NPROCESSORS_ONLN) << endl;
+  cout << "Threads | Socket compartilhado (quadros/s) | Socket por thread "
+          "(quadros/s)"
+       << endl;
+  for (unsigned int threads = 1; threads <= MAX_THREADS; threads *= 2) {
+    double shared = run<NIC<Engine<Ethernet>>>(threads);
+    double per_thread = run<NIC<Engine<Ethernet, PerThreadTxConfig>>>(threads);
+    cout << threads << " | " << shared << " | " << per_thread << endl;
+  }
+  return 0;
+}
@@ -0,0 +1,11 @@
+#include "engine_bench.hh"
+#include "xdp_engine.hh"
+
+// Compara a vazão da Engine de socket raw com a XdpEngine (AF_XDP em modo
+// genérico) em um par veth criado pelo próprio teste: o envio acontece em
+// uma ponta e a recepção na outra.
+
+int main() {
+  return EngineBench::compare_with_raw_socket<XdpEngine<Ethernet>>(
+      "XdpEngine (AF_XDP, modo genérico)", "xdpbench0", "xdpbench1");
+}